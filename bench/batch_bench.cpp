@@ -0,0 +1,149 @@
+// Batched versus scalar legal move counting over many independent positions.
+//
+//   batch-bench [file.epd] [--positions N]
+//
+// Positions come from an EPD file (first four FEN fields per line) or, when
+// none is given, from deterministic random games. They are loaded in chunks
+// into a pool of boards, then each chunk is counted twice: one
+// MoveGen::countLegalMoves call per board, and BatchMoveGen over
+// PositionBatch blocks of four, each pass on its own copy of the boards so
+// neither inherits cached attack data. Only the counting is timed. Exits
+// non-zero if the two paths ever disagree.
+
+#include "core/game/movegen/fill.hpp"
+#include "core/game/movegen/movegen.hpp"
+#include "core/game/movegen/movegen_batch.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int CHUNK = 256;
+
+// Fills the pool from the EPD stream; returns how many boards were set
+int loadEpd(std::ifstream& in, std::vector<std::unique_ptr<Board>>& pool) {
+    int n = 0;
+    std::string line;
+    while (n < CHUNK && std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string placement, side, castling, ep;
+        if (!(fields >> placement >> side >> castling >> ep)) continue;
+        pool[n++]->setFen(placement + " " + side + " " + castling + " " + ep + " 0 1");
+    }
+    return n;
+}
+
+// Random games: each pool slot is the running game a few plies further on
+struct RandomGames {
+    std::mt19937_64 rng{20240601};
+    Board game;
+    int plies = 0;
+
+    void next(Board& out) {
+        int steps = 1 + static_cast<int>(rng() % 3);
+        for (int i = 0; i < steps; ++i) {
+            MoveList moves;
+            MoveGen::generateLegalMoves(game, moves);
+            if (moves.empty() || plies >= 160) {
+                game.setFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+                plies = 0;
+                continue;
+            }
+            game.makeMove(moves[static_cast<int>(rng() % moves.size())]);
+            ++plies;
+        }
+        out = game;
+    }
+};
+
+double now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* epdPath = nullptr;
+    long long limit = 1000000;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--positions") == 0 && i + 1 < argc) {
+            limit = std::atoll(argv[++i]);
+        } else {
+            epdPath = argv[i];
+        }
+    }
+
+    std::ifstream epd;
+    if (epdPath) {
+        epd.open(epdPath);
+        if (!epd) {
+            std::fprintf(stderr, "cannot open %s\n", epdPath);
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<std::unique_ptr<Board>> pool;
+    for (int i = 0; i < CHUNK; ++i) pool.push_back(std::make_unique<Board>());
+    // Untouched copies for the batch pass, the scalar pass fills each
+    // board's cached AttackInfo and the batch fallback lanes would reuse it
+    std::vector<std::unique_ptr<Board>> batchPool;
+    for (int i = 0; i < CHUNK; ++i) batchPool.push_back(std::make_unique<Board>());
+    RandomGames games;
+
+    long long positions = 0, scalarMoves = 0, batchMoves = 0, mismatches = 0;
+    double scalarTime = 0, batchTime = 0;
+    std::vector<int> expected(CHUNK);
+
+    while (positions < limit) {
+        int n = 0;
+        if (epdPath) {
+            n = loadEpd(epd, pool);
+        } else {
+            n = static_cast<int>(std::min<long long>(CHUNK, limit - positions));
+            for (int i = 0; i < n; ++i) games.next(*pool[i]);
+        }
+        if (n == 0) break;
+        for (int i = 0; i < n; ++i) *batchPool[i] = *pool[i];
+
+        double t0 = now();
+        for (int i = 0; i < n; ++i) {
+            expected[i] = MoveGen::countLegalMoves(*pool[i]);
+        }
+        double t1 = now();
+
+        PositionBatch batch;
+        BatchResult result;
+        for (int i = 0; i < n; i += PositionBatch::LANES) {
+            batch.clear();
+            for (int j = i; j < n && !batch.full(); ++j) batch.push(*batchPool[j]);
+            BatchMoveGen::countLegalMoves(batch, result);
+            for (int j = 0; j < batch.size; ++j) {
+                batchMoves += result.legalMoves[j];
+                mismatches += result.legalMoves[j] != expected[i + j];
+            }
+        }
+        double t2 = now();
+
+        for (int i = 0; i < n; ++i) scalarMoves += expected[i];
+        scalarTime += t1 - t0;
+        batchTime += t2 - t1;
+        positions += n;
+    }
+
+    std::printf("%lld positions from %s\n", positions, epdPath ? epdPath : "random games");
+    std::printf("scalar  %7.1f ns/position  %6.2f M positions/s  (%lld moves)\n",
+                scalarTime * 1e9 / positions, positions / scalarTime / 1e6, scalarMoves);
+    std::printf("batch   %7.1f ns/position  %6.2f M positions/s  (%lld moves)  %s\n",
+                batchTime * 1e9 / positions, positions / batchTime / 1e6, batchMoves,
+                Fill::hasAVX2() ? "avx2" : "generic");
+    std::printf("%lld mismatch(es)\n", mismatches);
+    return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,162 @@
+// Perft regression and throughput suite.
+//
+// Runs the standard perft positions to fixed depths, prints nodes and
+// nodes/sec for each, and exits non-zero if any count differs from the
+// published reference. Driven by the `perft-bench` CMake target. Before
+// timing, every move in a shallow tree under each position is packed to 16
+// bits and unpacked again, and must come back identical.
+//
+//   perft-suite [--shallow] [--threads N] [--hash MB]
+//   perft-suite --scaling [depth]   startpos speedup against thread count
+
+#include "core/game/movegen/movegen.hpp"
+#include "core/game/perft/perft.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+struct PerftCase {
+    const char* name;
+    const char* fen;
+    int         depth;
+    uint64_t    nodes;
+    uint64_t    shallowNodes;   // at depth - SHALLOW_REDUCTION
+};
+
+constexpr int SHALLOW_REDUCTION = 2;
+
+// Reference counts from the chessprogramming wiki perft results and
+// the en passant / promotion / castling edge case collection. The shallow
+// counts of the edge cases, which the collection does not list, were taken
+// from this generator once it matched every full-depth count.
+constexpr PerftCase SUITE[] = {
+    {"startpos",        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",                 6, 119060324ULL, 197281ULL},
+    {"kiwipete",        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",     5, 193690690ULL,  97862ULL},
+    {"position3",       "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",                                6,  11030083ULL,  43238ULL},
+    {"position4",       "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",         5,  15833292ULL,   9467ULL},
+    {"position4-mirror","r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",         5,  15833292ULL,   9467ULL},
+    {"position5",       "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",                5,  89941194ULL,  62379ULL},
+    {"position6",       "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 5, 164075551ULL,  89890ULL},
+    {"ep-discovered-1", "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1",                                        6,   1134888ULL,  10138ULL},
+    {"ep-discovered-2", "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",                                      6,   1440467ULL,  13931ULL},
+    {"ep-avoid-check",  "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1",                                       6,   1015133ULL,  10276ULL},
+    {"castle-short",    "5k2/8/8/8/8/8/8/4K2R w K - 0 1",                                           6,    661072ULL,   6399ULL},
+    {"castle-long",     "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1",                                           6,    803711ULL,   7418ULL},
+    {"castle-rights",   "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1",                                4,   1274206ULL,   1141ULL},
+    {"castle-prevent",  "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1",                                 4,   1720476ULL,   1494ULL},
+    {"promote-out",     "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1",                                        6,   3821001ULL,  19174ULL},
+    {"discovered-check","8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1",                                      5,   1004658ULL,   5160ULL},
+    {"promote-check",   "4k3/1P6/8/8/8/8/K7/8 w - - 0 1",                                           6,    217342ULL,   2661ULL},
+    {"underpromote",    "8/P1k5/K7/8/8/8/8/8 w - - 0 1",                                            6,     92683ULL,   1329ULL},
+    {"self-stalemate",  "K1k5/8/P7/8/8/8/8/8 w - - 0 1",                                            6,      2217ULL,     63ULL},
+    {"stalemate-check", "8/k1P5/8/1K6/8/8/8/8 w - - 0 1",                                           7,    567584ULL,  10857ULL},
+    {"double-check",    "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1",                                        4,     23527ULL,    183ULL},
+};
+
+// Moves whose PackedMove round trip through Board::unpack changes them
+uint64_t packingErrors(Board& board, int depth, uint64_t& moves) {
+    MoveList list;
+    MoveGen::generateLegalMoves(board, list);
+
+    uint64_t errors = 0;
+    for (const Move& m : list) {
+        ++moves;
+        errors += board.unpack(PackedMove(m)) != m;
+        if (depth > 1) {
+            board.makeMove(m);
+            errors += packingErrors(board, depth - 1, moves);
+            board.unmakeMove();
+        }
+    }
+    return errors;
+}
+
+double timePerft(const Board& board, int depth, int threads, size_t hashMb, uint64_t& nodes) {
+    auto start = std::chrono::steady_clock::now();
+    nodes = Perft::runParallel(board, depth, threads, hashMb);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Startpos timings for 1..max(4, cores) threads, without and with the shared hash
+int runScaling(int depth) {
+    Board board;
+    int maxThreads = std::max(4u, std::thread::hardware_concurrency());
+    std::printf("startpos depth %d, %u hardware thread(s)\n", depth, std::thread::hardware_concurrency());
+
+    double base = 0;
+    for (size_t hashMb : {size_t(0), size_t(256)}) {
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            uint64_t nodes;
+            double seconds = timePerft(board, depth, threads, hashMb, nodes);
+            if (base == 0) base = seconds;
+            std::printf("threads %d  hash %4zu MB  %11llu nodes  %8.3f s  speedup %.2fx\n",
+                        threads, hashMb, static_cast<unsigned long long>(nodes), seconds, base / seconds);
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // --shallow runs every case two plies less for a quick correctness pass
+    bool shallow = false;
+    int threads = 1;
+    size_t hashMb = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--shallow") == 0) {
+            shallow = true;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--hash") == 0 && i + 1 < argc) {
+            hashMb = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--scaling") == 0) {
+            return runScaling(i + 1 < argc ? std::atoi(argv[i + 1]) : 6);
+        }
+    }
+
+    uint64_t totalNodes = 0;
+    double totalSeconds = 0;
+    int failures = 0;
+    Board board;
+
+    uint64_t packedMoves = 0, packedErrors = 0;
+    for (const PerftCase& c : SUITE) {
+        board.setFen(c.fen);
+        packedErrors += packingErrors(board, std::min(c.depth, 3), packedMoves);
+    }
+    failures += packedErrors != 0;
+    std::printf("packed move round trip: %llu moves, %llu error(s)\n",
+                static_cast<unsigned long long>(packedMoves), static_cast<unsigned long long>(packedErrors));
+
+    for (const PerftCase& c : SUITE) {
+        board.setFen(c.fen);
+        int depth = shallow ? c.depth - SHALLOW_REDUCTION : c.depth;
+        uint64_t expected = shallow ? c.shallowNodes : c.nodes;
+
+        uint64_t nodes;
+        double seconds = timePerft(board, depth, threads, hashMb, nodes);
+        bool ok = nodes == expected;
+        failures += !ok;
+        totalNodes += nodes;
+        totalSeconds += seconds;
+
+        std::printf("%-17s depth %d  %11llu nodes  %8.3f s  %7.2f Mnps  %s\n",
+                    c.name, depth, static_cast<unsigned long long>(nodes), seconds,
+                    nodes / (seconds + 1e-9) / 1e6, ok ? "ok" : "MISMATCH");
+        if (!ok) {
+            std::printf("  expected %llu\n", static_cast<unsigned long long>(expected));
+        }
+    }
+
+    std::printf("total %llu nodes in %.3f s, %.2f Mnps, %d mismatch(es)\n",
+                static_cast<unsigned long long>(totalNodes), totalSeconds,
+                totalNodes / (totalSeconds + 1e-9) / 1e6, failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+// Lazy SMP scaling report.
+//
+// Searches a fixed set of middlegame positions to a fixed depth once per
+// thread count, with a cleared transposition table each time, and prints
+// time-to-depth and nodes/sec with both speedups relative to one thread,
+// plus the share of nodes spent in quiescence search, how often the first
+// move searched caused a beta cutoff and the effective branching factor of
+// the last iteration (geometric mean over the positions).
+//
+//   search-scaling [depth] [--threads N] [--hash MB]
+//
+// Thread counts double from 1 up to N (default: hardware concurrency).
+
+#include "core/search/search.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+constexpr const char* POSITIONS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bq1rk1/pp2bppp/2n1pn2/2pp4/3P4/2PBPN2/PP1N1PPP/R2QK2R w KQ - 0 8",
+};
+
+struct Sample {
+    double   seconds;
+    uint64_t nodes;
+    uint64_t qnodes;
+    uint64_t cutoffs;
+    uint64_t firstMoveCutoffs;
+    double   branchingFactor;
+};
+
+Sample searchAll(int threads, int depth, size_t hashMb) {
+    TranspositionTable tt(hashMb);
+    std::ostringstream sink;   // info lines are not part of the report
+
+    Sample total{0.0, 0, 0, 0, 0, 1.0};
+    for (const char* fen : POSITIONS) {
+        Board board;
+        board.setFen(fen);
+        tt.clear();
+
+        Search search(tt, sink, threads);
+        SearchLimits limits;
+        limits.depth = depth;
+
+        auto start = std::chrono::steady_clock::now();
+        SearchResult result = search.run(board, limits);
+        total.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        total.nodes += result.nodes;
+        total.qnodes += result.qnodes;
+        total.cutoffs += result.cutoffs;
+        total.firstMoveCutoffs += result.firstMoveCutoffs;
+        total.branchingFactor *= result.branchingFactor;
+    }
+    total.branchingFactor = std::pow(total.branchingFactor, 1.0 / (sizeof(POSITIONS) / sizeof(POSITIONS[0])));
+    return total;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int depth = 7;
+    int maxThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    size_t hashMb = 64;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+            maxThreads = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--hash") && i + 1 < argc) {
+            hashMb = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else {
+            depth = std::max(1, std::atoi(argv[i]));
+        }
+    }
+
+    std::printf("%zu positions, depth %d, %zu MiB hash\n",
+                sizeof(POSITIONS) / sizeof(POSITIONS[0]), depth, hashMb);
+    std::printf("threads   time (s)      nodes        Mnps   ttd speedup   nps speedup   qsearch   first cut    EBF\n");
+
+    Sample base{0.0, 0, 0, 0, 0, 0.0};
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        Sample s = searchAll(threads, depth, hashMb);
+        if (threads == 1) {
+            base = s;
+        }
+        double nps = s.nodes / s.seconds;
+        std::printf("%7d %10.3f %12llu %11.2f %13.2fx %12.2fx %8.1f%% %10.1f%% %6.2f\n",
+                    threads, s.seconds, static_cast<unsigned long long>(s.nodes), nps / 1e6,
+                    base.seconds / s.seconds, nps / (base.nodes / base.seconds),
+                    100.0 * s.qnodes / s.nodes,
+                    100.0 * s.firstMoveCutoffs / std::max<uint64_t>(s.cutoffs, 1), s.branchingFactor);
+    }
+    return 0;
+}
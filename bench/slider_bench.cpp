@@ -0,0 +1,68 @@
+// Slider attack lookup micro-benchmark.
+//
+// Times getBishopAttacks/getRookAttacks over a fixed set of random
+// occupancies, then legal move generation on a middlegame position.
+// Built twice by CMake: slider-bench (magic multiply-shift) and, on
+// compilers that accept -mbmi2, slider-bench-pext (PEXT indexing).
+
+#include "core/game/movegen/movegen.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int SAMPLES = 1 << 16;
+constexpr int ROUNDS = 256;
+
+double seconds(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+template <typename Lookup>
+void timeLookups(const char* name, const std::vector<Square>& squares,
+                 const std::vector<bitboard>& occupancies, Lookup lookup) {
+    bitboard sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < ROUNDS; ++r)
+        for (int i = 0; i < SAMPLES; ++i)
+            sink += lookup(squares[i], occupancies[i] ^ r);
+    double s = seconds(t0);
+    double calls = double(SAMPLES) * ROUNDS;
+    std::printf("%-8s %7.2f ns/lookup  %8.1f M lookups/s  (checksum %016llx)\n",
+                name, s * 1e9 / calls, calls / s / 1e6, static_cast<unsigned long long>(sink));
+}
+
+} // namespace
+
+int main() {
+    std::printf("backend: %s, table %d entries (%zu KiB)\n",
+                USE_PEXT ? "pext" : "magic", MoveGen::SLIDER_TABLE_SIZE,
+                MoveGen::SLIDER_TABLE_SIZE * sizeof(bitboard) / 1024);
+
+    std::mt19937_64 rng(2024);
+    std::vector<Square> squares(SAMPLES);
+    std::vector<bitboard> occupancies(SAMPLES);
+    for (int i = 0; i < SAMPLES; ++i) {
+        squares[i] = static_cast<Square>(rng() & 63);
+        occupancies[i] = rng() & rng() & rng();
+    }
+
+    timeLookups("bishop", squares, occupancies, MoveGen::getBishopAttacks);
+    timeLookups("rook", squares, occupancies, MoveGen::getRookAttacks);
+
+    Board board;
+    board.setFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    constexpr int GENERATIONS = 2000000;
+    long long moves = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < GENERATIONS; ++i) {
+        MoveList list;
+        MoveGen::generateLegalMoves(board, list);
+        moves += list.size();
+    }
+    double s = seconds(t0);
+    std::printf("movegen  %7.1f M moves/s (Kiwipete, %d generations)\n", moves / s / 1e6, GENERATIONS);
+    return 0;
+}
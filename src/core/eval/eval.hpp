@@ -0,0 +1,9 @@
+#pragma once
+#include "../game/board/board.hpp"
+
+// Static evaluation: material plus piece-square tables
+class Eval {
+public:
+    // Centipawns from the side to move's point of view
+    static int evaluate(const Board& board);
+};
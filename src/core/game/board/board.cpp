@@ -1,218 +1,201 @@
 #include "board.hpp"
+#include <algorithm>
 #include "../../../util/zobrist.hpp"
 
 void Board::makeMove(Move m) {
-    if(false){
-        throw std::runtime_error("illegal move");
-    }
+    assert(ply < MAX_HISTORY);
+    attackInfoLevel = ATTACKS_NONE;
 
     Color mover = stm;
+    Color enemy = static_cast<Color>(1 - static_cast<int>(mover));
     Piece pc = static_cast<Piece>(m.piece() + (mover * 6)); // Convert from 0-5 range to 0-11 range
-    Square from = static_cast<Square>(m.from());
-    Square to = static_cast<Square>(m.to());
+    Square from = m.from();
+    Square to = m.to();
 
-    Piece captured = NO_PIECE;
-    if (m.isEP()) {
-        int offset   = (mover == WHITE ? -8 : 8);
-        Square capSq = Square(int(to) + offset);
-        captured     = Piece(PAWN + 6 * (1 - int(mover)));
-
-        pieceBB[captured]     &= ~(1ULL << int(capSq));
-        occ[1 - int(mover)]   &= ~(1ULL << int(capSq));
-        occAll               &= ~(1ULL << int(capSq));
-        hashKey              ^= Zobrist::pieceSquare(captured, capSq);
-    }
-    else if (m.isCapture()) {
-        captured = pieceAt(to);
-        if (captured != NO_PIECE) { // Extra guard to prevent out-of-range access
-            pieceBB[captured]     &= ~(1ULL << int(to));
-            occ[1 - int(mover)]   &= ~(1ULL << int(to));
-            occAll               &= ~(1ULL << int(to));
-            hashKey              ^= Zobrist::pieceSquare(captured, to);
-        }
-    }
-
-    int oldEp = ep;
-    uint8_t oldRights = castlingRights;
-
-    StateInfo state;
+    StateInfo& state = history[ply++];
     state.hashKey = hashKey;
+    state.move = PackedMove(m);
     state.castlingRights = castlingRights;
     state.epFile = ep;
     state.fiftyMoveCounter = halfmoveClock;
-    state.move = m;
-    state.captured = captured;
-    state.stm = stm;
-    state.fullmoveNo = fullmoveNo;
-    state.pieceBB = pieceBB;
-    state.occ = occ;
-    state.occAll = occAll;
-    history.push_back(state);
-
-    movePiece(pc, from, to);
-
-    handleSpecialMoves(m, pc, from, to, captured);
 
-    updateGameState(m, pc, mover, oldEp, oldRights);
-}
-
-void Board::handleSpecialMoves(Move m, Piece pc, Square from, Square to, Piece captured) {
-    Color mover = stm;
-
-    if(pc == static_cast<Piece>(KING + (mover * 6))){
-        if(m.to() == Square::G1){
-            movePiece(static_cast<Piece>(ROOK + (mover * 6)), Square::H1, Square::F1);
-        }
-        if(m.to() == Square::C1){
-            movePiece(static_cast<Piece>(ROOK + (mover * 6)), Square::A1, Square::D1);
-        }
-        if(m.to() == Square::G8){
-            movePiece(static_cast<Piece>(ROOK + (mover * 6)), Square::H8, Square::F8);
-        }
-        if(m.to() == Square::C8){
-            movePiece(static_cast<Piece>(ROOK + (mover * 6)), Square::A8, Square::D8);
-        }
+    // Remove the old en passant file and castling rights from the key
+    if (ep != -1) {
+        hashKey ^= Zobrist::enPassantKey(ep);
     }
+    hashKey ^= Zobrist::castlingKey(castlingRights);
 
-    if(m.isPromotion()){
-        pieceBB[pc] &= ~(1ULL << static_cast<int>(to));
-        Piece promoted = static_cast<Piece>(m.promotion() + (mover * 6)); // Convert from 0-5 range to 0-11 range
-        pieceBB[promoted] |= (1ULL << static_cast<int>(to));
+    Piece captured = NO_PIECE;
+    if (m.isEP()) {
+        Square capSq = Square(int(to) + (mover == WHITE ? -8 : 8));
+        captured = Piece(PAWN + 6 * enemy);
+        removePiece(captured, capSq);
+        hashKey ^= Zobrist::pieceSquare(captured, capSq);
+    } else if (m.isCapture()) {
+        captured = mailbox[int(to)];
+        removePiece(captured, to);
+        hashKey ^= Zobrist::pieceSquare(captured, to);
+    }
+    state.captured = static_cast<int8_t>(captured);
 
-        updateOccupancy();
-        hashKey ^= Zobrist::pieceSquare(pc, m.to());  // Remove pawn
-        hashKey ^= Zobrist::pieceSquare(promoted, m.to());  // Add promoted piece
+    movePiece(pc, from, to);
+    hashKey ^= Zobrist::pieceSquare(pc, from) ^ Zobrist::pieceSquare(pc, to);
+
+    if (m.isPromotion()) {
+        Piece promoted = static_cast<Piece>(m.promotion() + (mover * 6));
+        removePiece(pc, to);
+        putPiece(promoted, to);
+        hashKey ^= Zobrist::pieceSquare(pc, to) ^ Zobrist::pieceSquare(promoted, to);
+    } else if (m.isCastle()) {
+        Square rookFrom, rookTo;
+        castlingRookSquares(to, rookFrom, rookTo);
+        Piece rook = static_cast<Piece>(ROOK + (mover * 6));
+        movePiece(rook, rookFrom, rookTo);
+        hashKey ^= Zobrist::pieceSquare(rook, rookFrom) ^ Zobrist::pieceSquare(rook, rookTo);
     }
 
-    if (m.isDoublePush()) {
-        ep = static_cast<int>(to) % 8;
-    } else {
-        ep = -1;
+    ep = m.isDoublePush() ? static_cast<int>(to) % 8 : -1;
+    if (ep != -1) {
+        hashKey ^= Zobrist::enPassantKey(ep);
     }
-}
 
-void Board::updateGameState(Move m, Piece pc, Color mover, int oldEp, uint8_t oldRights) {
-    if(pc == static_cast<Piece>(PAWN + (mover * 6)) || m.isCapture()){
+    // Moving from or capturing on a king or rook home square clears the matching rights
+    castlingRights &= CASTLING_MASK[static_cast<int>(from)] & CASTLING_MASK[static_cast<int>(to)];
+    hashKey ^= Zobrist::castlingKey(castlingRights);
+
+    if (m.piece() == PAWN || captured != NO_PIECE) {
         halfmoveClock = 0;
     } else {
         halfmoveClock++;
     }
 
-    if(mover == BLACK){
+    if (mover == BLACK) {
         fullmoveNo++;
     }
 
-    if(oldEp != -1) {
-        hashKey ^= Zobrist::enPassantKey(oldEp);
-    }
-    hashKey ^= Zobrist::castlingKey(oldRights);
+    stm = enemy;
     hashKey ^= Zobrist::sideToMoveKey();
 
-    hashKey ^= Zobrist::pieceSquare(pc, m.from());
-    hashKey ^= Zobrist::pieceSquare(pc, m.to());
+    assert(mailboxConsistent());
+    assert(hashKey == Zobrist::hashPosition(*this));
+}
 
-    if(m.isPromotion()) {
-        Piece promoted = static_cast<Piece>(m.promotion() + (mover * 6)); // Convert from 0-5 range to 0-11 range
-        hashKey ^= Zobrist::pieceSquare(pc, m.to());  // Remove pawn
-        hashKey ^= Zobrist::pieceSquare(promoted, m.to());  // Add promoted piece
-    }
+void Board::unmakeMove() {
+    if (ply == 0) return;
 
-    if(pc == static_cast<Piece>(KING + (mover * 6)) && m.isCastle()) {
-        Square rookFrom = NO_SQUARE, rookTo = NO_SQUARE;
-        if(m.to() == Square::G1) {
-            rookFrom = Square::H1; rookTo = Square::F1;
-        } else if(m.to() == Square::C1) {
-            rookFrom = Square::A1; rookTo = Square::D1;
-        } else if(m.to() == Square::G8) {
-            rookFrom = Square::H8; rookTo = Square::F8;
-        } else if(m.to() == Square::C8) {
-            rookFrom = Square::A8; rookTo = Square::D8;
-        }
-        if(rookFrom != NO_SQUARE) {
-            Piece rookPiece = static_cast<Piece>(ROOK + (mover * 6)); // Convert from 0-5 range to 0-11 range
-            hashKey ^= Zobrist::pieceSquare(rookPiece, rookFrom);
-            hashKey ^= Zobrist::pieceSquare(rookPiece, rookTo);
+    const StateInfo& state = history[--ply];
+    attackInfoLevel = ATTACKS_NONE;
+    PackedMove m = state.move;
+
+    stm = static_cast<Color>(1 - static_cast<int>(stm));
+    Color mover = stm;
+    Square from = m.from();
+    Square to = m.to();
+
+    // Reverse the piece placement in the opposite order of makeMove. The
+    // moving piece is whatever stands on the destination, unless promoted.
+    Piece pc;
+    if (m.kind() == PackedMove::PROMOTION) {
+        pc = static_cast<Piece>(PAWN + (mover * 6));
+        removePiece(mailbox[static_cast<int>(to)], to);
+        putPiece(pc, to);
+    } else {
+        pc = mailbox[static_cast<int>(to)];
+        if (m.kind() == PackedMove::CASTLING) {
+            Square rookFrom, rookTo;
+            castlingRookSquares(to, rookFrom, rookTo);
+            movePiece(static_cast<Piece>(ROOK + (mover * 6)), rookTo, rookFrom);
         }
     }
 
-    if(pc == static_cast<Piece>(KING + (mover * 6))) {
-        uint8_t newRights = castlingRights & ~(mover == WHITE ? 0x3 : 0xC);  // Clear KQ for moving side
-        if(newRights != oldRights) {
-            hashKey ^= Zobrist::castlingKey(oldRights);
-            hashKey ^= Zobrist::castlingKey(newRights);
-            oldRights = newRights;
-        }
-        castlingRights = newRights;
-    } else if(pc == static_cast<Piece>(ROOK + (mover * 6))) {
-        uint8_t newRights = castlingRights;
-        if(m.from() == Square::A1) newRights &= ~0x1;  // Clear Q for white
-        if(m.from() == Square::H1) newRights &= ~0x2;  // Clear K for white
-        if(m.from() == Square::A8) newRights &= ~0x4;  // Clear Q for black
-        if(m.from() == Square::H8) newRights &= ~0x8;  // Clear K for black
-        if(newRights != oldRights) {
-            hashKey ^= Zobrist::castlingKey(oldRights);
-            hashKey ^= Zobrist::castlingKey(newRights);
-            oldRights = newRights;
-        }
-        castlingRights = newRights;
-    } else if(m.isCapture() && history.back().captured == static_cast<Piece>(ROOK + ((1 - mover) * 6))) {
-        uint8_t newRights = castlingRights;
-        if(m.to() == Square::A1) newRights &= ~0x1;  // Clear Q for white
-        if(m.to() == Square::H1) newRights &= ~0x2;  // Clear K for white
-        if(m.to() == Square::A8) newRights &= ~0x4;  // Clear Q for black
-        if(m.to() == Square::H8) newRights &= ~0x8;  // Clear K for black
-        if(newRights != oldRights) {
-            hashKey ^= Zobrist::castlingKey(oldRights);
-            hashKey ^= Zobrist::castlingKey(newRights);
-            oldRights = newRights;
-        }
-        castlingRights = newRights;
+    movePiece(pc, to, from);
+
+    if (state.captured != NO_PIECE) {
+        Square capSq = m.kind() == PackedMove::EN_PASSANT ? Square(int(to) + (mover == WHITE ? -8 : 8)) : to;
+        putPiece(static_cast<Piece>(state.captured), capSq);
     }
 
-    if(ep != -1) {
-        hashKey ^= Zobrist::enPassantKey(ep);
+    // Restore the irreversible state
+    hashKey = state.hashKey;
+    castlingRights = state.castlingRights;
+    ep = state.epFile;
+    halfmoveClock = state.fiftyMoveCounter;
+    if (mover == BLACK) {
+        fullmoveNo--;
     }
-    hashKey ^= Zobrist::castlingKey(castlingRights);
 
+    assert(mailboxConsistent());
+    assert(hashKey == Zobrist::hashPosition(*this));
+}
+
+void Board::makeNullMove() {
+    assert(ply < MAX_HISTORY);
+    attackInfoLevel = ATTACKS_NONE;
+
+    StateInfo& state = history[ply++];
+    state.hashKey = hashKey;
+    state.move = PackedMove();
+    state.captured = NO_PIECE;
+    state.castlingRights = castlingRights;
+    state.epFile = ep;
+    state.fiftyMoveCounter = halfmoveClock;
+
+    if (ep != -1) {
+        hashKey ^= Zobrist::enPassantKey(ep);
+        ep = -1;
+    }
+    halfmoveClock = 0;
     stm = static_cast<Color>(1 - static_cast<int>(stm));
     hashKey ^= Zobrist::sideToMoveKey();
+
+    assert(hashKey == Zobrist::hashPosition(*this));
 }
 
-void Board::unmakeMove() {
-    if (history.empty()) return;
-    
-    const StateInfo& lastState = history.back();
-    
-    // Restore all state
-    hashKey = lastState.hashKey;
-    castlingRights = lastState.castlingRights;
-    ep = lastState.epFile;
-    halfmoveClock = lastState.fiftyMoveCounter;
-    stm = lastState.stm;
-    fullmoveNo = lastState.fullmoveNo;
-    pieceBB = lastState.pieceBB;
-    occ = lastState.occ;
-    occAll = lastState.occAll;
-    
-    // Update ply
-    ply--;
-    
-    // Remove the last state
-    history.pop_back();
+void Board::unmakeNullMove() {
+    assert(ply > 0 && history[ply - 1].move.isNone());
+
+    const StateInfo& state = history[--ply];
+    attackInfoLevel = ATTACKS_NONE;
+    stm = static_cast<Color>(1 - static_cast<int>(stm));
+    hashKey = state.hashKey;
+    ep = state.epFile;
+    halfmoveClock = state.fiftyMoveCounter;
 }
 
+// Piece placement primitives: XOR deltas keep pieceBB, occ, occAll and the mailbox in step
 void Board::movePiece(Piece pc, Square from, Square to) noexcept {
-
     bitboard m = 1ULL << static_cast<int>(from) | 1ULL << static_cast<int>(to);
-    pieceBB[pc] ^= m;  
-    updateOccupancy();
+    pieceBB[pc] ^= m;
+    occ[pc / 6] ^= m;
+    occAll ^= m;
+    mailbox[static_cast<int>(from)] = NO_PIECE;
+    mailbox[static_cast<int>(to)] = pc;
+}
+
+void Board::putPiece(Piece pc, Square sq) noexcept {
+    bitboard b = 1ULL << static_cast<int>(sq);
+    pieceBB[pc] ^= b;
+    occ[pc / 6] ^= b;
+    occAll ^= b;
+    mailbox[static_cast<int>(sq)] = pc;
+}
+
+void Board::removePiece(Piece pc, Square sq) noexcept {
+    bitboard b = 1ULL << static_cast<int>(sq);
+    pieceBB[pc] ^= b;
+    occ[pc / 6] ^= b;
+    occAll ^= b;
+    mailbox[static_cast<int>(sq)] = NO_PIECE;
 }
 
 void Board::setFen(const std::string& fen) {
     // Clear all bitboards
-    pieceBB[PAWN] = pieceBB[KNIGHT] = pieceBB[BISHOP] = pieceBB[ROOK] = pieceBB[QUEEN] = pieceBB[KING] = 0ULL;
+    pieceBB.fill(0ULL);
+    mailbox.fill(NO_PIECE);
     occ[WHITE] = occ[BLACK] = 0ULL;
     occAll = 0ULL;
+    ply = 0;
+    attackInfoLevel = ATTACKS_NONE;
 
     std::istringstream fenStream(fen);
     std::string boardPos, side, castle, epStr, halfmove, fullmove;
@@ -235,19 +218,24 @@ void Board::setFen(const std::string& fen) {
             int square = rank * 8 + file;
             bitboard bitPosition = 1ULL << square;
             
+            Piece piece = NO_PIECE;
             switch (c) {
-                case 'P': pieceBB[PAWN] |= bitPosition; break;
-                case 'N': pieceBB[KNIGHT] |= bitPosition; break;
-                case 'B': pieceBB[BISHOP] |= bitPosition; break;
-                case 'R': pieceBB[ROOK] |= bitPosition; break;
-                case 'Q': pieceBB[QUEEN] |= bitPosition; break;
-                case 'K': pieceBB[KING] |= bitPosition; break;
-                case 'p': pieceBB[PAWN + 6] |= bitPosition; break;
-                case 'n': pieceBB[KNIGHT + 6] |= bitPosition; break;
-                case 'b': pieceBB[BISHOP + 6] |= bitPosition; break;
-                case 'r': pieceBB[ROOK + 6] |= bitPosition; break;
-                case 'q': pieceBB[QUEEN + 6] |= bitPosition; break;
-                case 'k': pieceBB[KING + 6] |= bitPosition; break;
+                case 'P': piece = PAWN; break;
+                case 'N': piece = KNIGHT; break;
+                case 'B': piece = BISHOP; break;
+                case 'R': piece = ROOK; break;
+                case 'Q': piece = QUEEN; break;
+                case 'K': piece = KING; break;
+                case 'p': piece = static_cast<Piece>(PAWN + 6); break;
+                case 'n': piece = static_cast<Piece>(KNIGHT + 6); break;
+                case 'b': piece = static_cast<Piece>(BISHOP + 6); break;
+                case 'r': piece = static_cast<Piece>(ROOK + 6); break;
+                case 'q': piece = static_cast<Piece>(QUEEN + 6); break;
+                case 'k': piece = static_cast<Piece>(KING + 6); break;
+            }
+            if (piece != NO_PIECE) {
+                pieceBB[piece] |= bitPosition;
+                mailbox[square] = piece;
             }
             file++;
         }
@@ -261,10 +249,10 @@ void Board::setFen(const std::string& fen) {
     if(castle != "-") {
         for(char c : castle) {
             switch(c) {
-                case 'K': castlingRights |= 0x2; break;
-                case 'Q': castlingRights |= 0x1; break;
-                case 'k': castlingRights |= 0x8; break;
-                case 'q': castlingRights |= 0x4; break;
+                case 'K': castlingRights |= WHITE_OO;  break;
+                case 'Q': castlingRights |= WHITE_OOO; break;
+                case 'k': castlingRights |= BLACK_OO;  break;
+                case 'q': castlingRights |= BLACK_OOO; break;
             }
         }
     }
@@ -284,6 +272,10 @@ void Board::setFen(const std::string& fen) {
 
     // Update occupancy
     updateOccupancy();
+
+    hashKey = Zobrist::hashPosition(*this);
+
+    assert(mailboxConsistent());
 }
 
 void Board::updateOccupancy() noexcept {
@@ -293,4 +285,38 @@ void Board::updateOccupancy() noexcept {
         occ[BLACK] |= pieceBB[i + 6];
     }
     occAll = occ[WHITE] | occ[BLACK];
-}
\ No newline at end of file
+}
+
+void Board::castlingRookSquares(Square kingTo, Square& rookFrom, Square& rookTo) noexcept {
+    switch (kingTo) {
+        case Square::G1: rookFrom = Square::H1; rookTo = Square::F1; break;
+        case Square::C1: rookFrom = Square::A1; rookTo = Square::D1; break;
+        case Square::G8: rookFrom = Square::H8; rookTo = Square::F8; break;
+        default:         rookFrom = Square::A8; rookTo = Square::D8; break;
+    }
+}
+
+bool Board::isRepetition() const noexcept {
+    // Only positions with the same side to move inside the fifty-move window
+    int stop = std::max(ply - static_cast<int>(halfmoveClock), 0);
+    for (int i = ply - 2; i >= stop; i -= 2) {
+        if (history[i].hashKey == hashKey) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Board::mailboxConsistent() const noexcept {
+    for (int sq = 0; sq < 64; ++sq) {
+        Piece expected = NO_PIECE;
+        for (int p = 0; p < 12; ++p) {
+            if (pieceBB[p] & (1ULL << sq)) {
+                expected = Piece(p);
+                break;
+            }
+        }
+        if (mailbox[sq] != expected) return false;
+    }
+    return true;
+}
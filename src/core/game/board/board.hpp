@@ -3,8 +3,8 @@
 #include <array>
 #include <cstdint>
 #include <string>
-#include <vector>
 #include "../move/move.hpp"
+#include "../move/packed_move.hpp"
 #include <cassert>
 #include "../../../util/util.hpp"
 #include "../../../util/zobrist.hpp"
@@ -13,28 +13,41 @@ using namespace util;
 
 static constexpr Square NO_SQUARE = static_cast<Square>(-1);
 
+// Undo record: only what makeMove cannot recompute when reversing a move.
+// The moving piece is found again on the destination square, so a packed
+// move is enough and the record fits in 16 bytes.
 struct StateInfo {
-    uint64_t hashKey;
-    uint8_t  castlingRights;
-    int      epFile;
-    uint8_t  fiftyMoveCounter;
-    Move     move;
-    Piece    captured;
-    Color    stm;
-    uint16_t fullmoveNo;
-    std::array<bitboard,12> pieceBB;
-    std::array<bitboard,2>  occ;
-    bitboard occAll;
+    uint64_t   hashKey;
+    PackedMove move;
+    int8_t     captured;              // Piece, NO_PIECE if none
+    uint8_t    castlingRights;
+    int8_t     epFile;
+    uint8_t    fiftyMoveCounter;
+};
+
+static_assert(sizeof(StateInfo) == 16);
+
+// Attack data derived from the piece placement. Board caches one per
+// position; MoveGen::attackInfo fills it on first use and makeMove /
+// unmakeMove drop it.
+struct AttackInfo {
+    bitboard checkers;           // enemy pieces attacking the side to move's king
+    bitboard pinned[2];          // [color] pieces pinned to their own king
+    bitboard kingDanger;         // enemy attacks with the side to move's king removed
+    bitboard attacked[2];        // [color] every square that side attacks
+    bitboard pieceAttacks[2][6]; // [color][piece type]
 };
 
 class Board {
     public:
         Board() {
-            Zobrist::init();
             setFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
         }
         ~Board() = default;
 
+        // Undo stack depth: game plies plus search depth
+        static constexpr int MAX_HISTORY = 2048;
+
         static constexpr std::array<bitboard, 8> FileBB{
             0x0101010101010101ULL, 0x0202020202020202ULL,
             0x0404040404040404ULL, 0x0808080808080808ULL,
@@ -51,6 +64,25 @@ class Board {
 
         static constexpr bitboard DarkSquares = 0xAA55AA55AA55AA55ULL;
 
+        // Castling right bits, laid out as 1 << (side * 2 + type)
+        static constexpr uint8_t WHITE_OO  = 0x1;
+        static constexpr uint8_t WHITE_OOO = 0x2;
+        static constexpr uint8_t BLACK_OO  = 0x4;
+        static constexpr uint8_t BLACK_OOO = 0x8;
+
+        // Rights that survive a move touching each square
+        static constexpr std::array<uint8_t, 64> CASTLING_MASK = [] {
+            std::array<uint8_t, 64> mask{};
+            mask.fill(0xF);
+            mask[0]  = static_cast<uint8_t>(~WHITE_OOO & 0xF);
+            mask[4]  = static_cast<uint8_t>(~(WHITE_OO | WHITE_OOO) & 0xF);
+            mask[7]  = static_cast<uint8_t>(~WHITE_OO & 0xF);
+            mask[56] = static_cast<uint8_t>(~BLACK_OOO & 0xF);
+            mask[60] = static_cast<uint8_t>(~(BLACK_OO | BLACK_OOO) & 0xF);
+            mask[63] = static_cast<uint8_t>(~BLACK_OO & 0xF);
+            return mask;
+        }();
+
         const bitboard& pawns(Color c) const noexcept { return pieceBB[PAWN + 6*c]; }
         const bitboard& knights (Color c) const noexcept { return pieceBB[KNIGHT + 6*c]; }
         const bitboard& bishops (Color c) const noexcept { return pieceBB[BISHOP + 6*c]; }
@@ -61,6 +93,11 @@ class Board {
     
         void makeMove(Move m);
         void unmakeMove();
+
+        // Passes the turn for null move pruning. Resets the halfmove clock
+        // so repetition checks do not look past the null move.
+        void makeNullMove();
+        void unmakeNullMove();
         void setFen(const std::string& fen);
     
         Color getSideToMove() const { return stm; }
@@ -73,22 +110,50 @@ class Board {
         bitboard getWhitePieces() const { return occ[WHITE]; }
         bitboard getBlackPieces() const { return occ[BLACK]; }
         int getEpFile() const { return ep; }
+        uint8_t getCastlingRights() const { return castlingRights; }
+        uint64_t getHashKey() const { return hashKey; }
+        int getHalfmoveClock() const { return halfmoveClock; }
+
+        // Current position occurred before since the last capture or pawn move
+        bool isRepetition() const noexcept;
 
         bool hasCastlingRight(Color side, int type) const {
             return castlingRights & (1 << (side * 2 + type));
         }
 
-        Piece pieceAt(Square square) const {
-            bitboard bb = 1ULL << static_cast<int>(square);
-            constexpr int PIECE_NB = 12;
-            for (int p = 0; p < PIECE_NB; ++p)
-                if (pieceBB[p] & bb) return Piece(p);
-
-            return NO_PIECE;
+        Piece pieceAt(Square square) const noexcept { return mailbox[static_cast<int>(square)]; }
+
+        // Rebuilds the full move from its packed form in this position. The
+        // move must have been packed from a move legal here.
+        Move unpack(PackedMove pm) const noexcept {
+            Square from = pm.from();
+            Square to = pm.to();
+            Piece pc = static_cast<Piece>(mailbox[static_cast<int>(from)] % 6);
+
+            switch (pm.kind()) {
+            case PackedMove::EN_PASSANT:
+                return makeEP(from, to, PAWN);
+            case PackedMove::CASTLING:
+                return makeCastle(from, to);
+            default: {
+                Piece target = mailbox[static_cast<int>(to)];
+                Piece captured = target == NO_PIECE ? NO_PIECE : static_cast<Piece>(target % 6);
+                int distance = static_cast<int>(to) - static_cast<int>(from);
+                int flags = pc == PAWN && (distance == 16 || distance == -16) ? Move::DPUSH : Move::QUIET;
+                return Move(from, to, pc, captured, pm.promotion(), flags);
+            }
+            }
         }
 
+        // Last move played, NO_MOVE at the root
+        PackedMove lastMove() const noexcept { return ply ? history[ply - 1].move : PackedMove(); }
+
+        // Debug check that the mailbox agrees with the piece bitboards
+        bool mailboxConsistent() const noexcept;
+
     private:
         std::array<bitboard,12> pieceBB{};
+        std::array<Piece,64>    mailbox{};   // piece on each square, NO_PIECE if empty
         std::array<bitboard,2>  occ{};
         bitboard                occAll{};
 
@@ -99,13 +164,20 @@ class Board {
         uint8_t halfmoveClock{};
         uint16_t fullmoveNo{1};
 
-        std::vector<StateInfo> history;
+        std::array<StateInfo, MAX_HISTORY> history;
         int ply{0};
 
+        // Filled in two steps by MoveGen: the legality fields first, the full
+        // attack maps only when someone asks for them
+        enum AttackInfoLevel : uint8_t { ATTACKS_NONE, ATTACKS_LEGALITY, ATTACKS_FULL };
+        mutable AttackInfo      attackInfo{};
+        mutable AttackInfoLevel attackInfoLevel{ATTACKS_NONE};
+        friend class MoveGen;
+
         void updateOccupancy() noexcept;
         void movePiece(Piece pc, Square from, Square to) noexcept;
-        
-        void handleSpecialMoves(Move m, Piece pc, Square from, Square to, Piece captured);
-        void updateGameState(Move m, Piece pc, Color mover, int oldEp, uint8_t oldRights);
-        void updateMoveHistory(Move m);
+        void putPiece(Piece pc, Square sq) noexcept;
+        void removePiece(Piece pc, Square sq) noexcept;
+
+        static void castlingRookSquares(Square kingTo, Square& rookFrom, Square& rookTo) noexcept;
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include <string>
 #include "../../../util/util.hpp"
 using namespace util;
 struct Move {
@@ -14,7 +15,7 @@ struct Move {
     static constexpr int           CAP_SHIFT   = 16;
     static constexpr std::uint32_t PROMO_MASK = 0x00700000;
     static constexpr int           PROMO_SHIFT = 20;
-    static constexpr std::uint32_t FLAGS_MASK = 0x03800000;
+    static constexpr std::uint32_t FLAGS_MASK = 0x01800000;
     static constexpr int           FLAGS_SHIFT = 23;
 
     constexpr Move() noexcept = default;
@@ -25,19 +26,19 @@ struct Move {
             (static_cast<int>(to) & 0x3F) |
             ((static_cast<int>(from) & 0x3F) << 6) |
             ((static_cast<int>(pc) & 0x0F) << 12) |
-            (((cap == NO_PIECE ? 0 : static_cast<int>(cap)) & 0x0F) << 16) |
+            (((static_cast<int>(cap) + 1) & 0x0F) << 16) |   // 0 = no capture
             (((promo == NO_PIECE ? 0 : static_cast<int>(promo)) & 0x07) << 20) |
-            ((fl & 0x07) << 23)) {}
+            ((fl & 0x03) << 23)) {}
 
     [[nodiscard]] constexpr Square from()       const noexcept { return Square((value >> 6)  & 0x3F); }
     [[nodiscard]] constexpr Square to()         const noexcept { return Square(value        & 0x3F); }
     [[nodiscard]] constexpr Piece  piece()      const noexcept { return Piece((value >> 12) & 0x0F); }
-    [[nodiscard]] constexpr Piece  captured()   const noexcept { return Piece((value >> 16) & 0x0F); }
+    [[nodiscard]] constexpr Piece  captured()   const noexcept { return Piece(static_cast<int>((value >> 16) & 0x0F) - 1); }
     [[nodiscard]] constexpr Piece  promotion()  const noexcept {
         int p = (value >> 20) & 0x07;
         return p == 0 ? NO_PIECE : static_cast<Piece>(p);
     }
-    [[nodiscard]] constexpr int    flags()      const noexcept { return (value >> 23) & 0x07; }
+    [[nodiscard]] constexpr int    flags()      const noexcept { return (value >> 23) & 0x03; }
 
     [[nodiscard]] constexpr bool isCapture()     const noexcept { return captured()  != NO_PIECE; }
     [[nodiscard]] constexpr bool isPromotion()   const noexcept { return promotion() != NO_PIECE; }
@@ -45,11 +46,17 @@ struct Move {
     [[nodiscard]] constexpr bool isCastle()      const noexcept { return flags() == CASTLE; }
     [[nodiscard]] constexpr bool isDoublePush()  const noexcept { return flags() == DPUSH; }
     [[nodiscard]] constexpr bool isQuiet()       const noexcept { return !isCapture() && !isPromotion() && !isEP() && !isCastle(); }
+    [[nodiscard]] constexpr bool isNone()        const noexcept { return (value & ~SCORE_MASK) == 0; }
 
     enum Flag : int { QUIET = 0, DPUSH = 1, EP = 2, CASTLE = 3 };
 
-    constexpr void setScore(std::uint8_t s) noexcept { value = (value & 0x00FFFFFF) | (s << 24); }
-    [[nodiscard]] constexpr std::uint8_t score() const noexcept { return value >> 24; }
+    // Ordering score in the top 7 bits, clear of the flags
+    static constexpr std::uint32_t SCORE_MASK = 0xFE000000;
+    static constexpr int           SCORE_SHIFT = 25;
+    static constexpr std::uint8_t  MAX_SCORE   = 127;
+
+    constexpr void setScore(std::uint8_t s) noexcept { value = (value & ~SCORE_MASK) | (static_cast<std::uint32_t>(s & MAX_SCORE) << SCORE_SHIFT); }
+    [[nodiscard]] constexpr std::uint8_t score() const noexcept { return value >> SCORE_SHIFT; }
 
     friend constexpr bool operator==(Move a, Move b) { return a.value == b.value; }
     friend constexpr bool operator!=(Move a, Move b) { return !(a == b); }
@@ -62,3 +69,17 @@ inline constexpr Move makePromo   (Square f, Square t, Piece pc, Piece promo, bo
 }
 inline constexpr Move makeEP      (Square f, Square t, Piece pc)                 { return Move(f,t,pc,PAWN,NO_PIECE,Move::EP); }
 inline constexpr Move makeCastle  (Square f, Square t)                           { return Move(f,t,KING,NO_PIECE,NO_PIECE,Move::CASTLE); }
+
+// Long algebraic notation as used by UCI, e.g. e2e4, e7e8q
+inline std::string moveToUci(Move m) {
+    int from = static_cast<int>(m.from());
+    int to = static_cast<int>(m.to());
+    std::string s{
+        static_cast<char>('a' + from % 8), static_cast<char>('1' + from / 8),
+        static_cast<char>('a' + to % 8),   static_cast<char>('1' + to / 8)
+    };
+    if (m.isPromotion()) {
+        s += "pnbrqk"[m.promotion()];
+    }
+    return s;
+}
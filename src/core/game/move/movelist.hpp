@@ -0,0 +1,42 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include "move.hpp"
+
+// Fixed-capacity move buffer that lives on the stack of the caller.
+// 256 covers the known maximum of 218 legal moves in any chess position.
+class MoveList {
+public:
+    static constexpr int CAPACITY = 256;
+
+    // Storage is left uninitialised on purpose: only [0, size()) is ever read.
+    MoveList() noexcept {}
+
+    void push(Move m) noexcept {
+        assert(count < CAPACITY);
+        moves[count++] = m;
+    }
+
+    void clear() noexcept { count = 0; }
+
+    [[nodiscard]] int  size()  const noexcept { return count; }
+    [[nodiscard]] bool empty() const noexcept { return count == 0; }
+
+    [[nodiscard]] bool contains(Move m) const noexcept {
+        for (int i = 0; i < count; ++i)
+            if (moves[i] == m) return true;
+        return false;
+    }
+
+    Move&       operator[](int i)       noexcept { assert(i < count); return moves[i]; }
+    const Move& operator[](int i) const noexcept { assert(i < count); return moves[i]; }
+
+    Move*       begin()       noexcept { return moves; }
+    Move*       end()         noexcept { return moves + count; }
+    const Move* begin() const noexcept { return moves; }
+    const Move* end()   const noexcept { return moves + count; }
+
+private:
+    union { Move moves[CAPACITY]; };
+    int count = 0;
+};
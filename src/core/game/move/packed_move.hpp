@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "move.hpp"
+
+// 16-bit move for bulk storage (hash entries, PV and book records, game
+// history). Only from, to and the promotion/special kind are kept; the
+// moving and captured pieces are read back from the board the move is
+// played on (Board::unpack).
+//
+//   bits  0-5   to square
+//   bits  6-11  from square
+//   bits 12-13  promotion piece, KNIGHT..QUEEN minus one
+//   bits 14-15  kind: normal, promotion, en passant, castling
+struct PackedMove {
+    std::uint16_t value = 0;           // 0 = NO_MOVE (a1a1 is never a move)
+
+    enum Kind : int { NORMAL = 0, PROMOTION = 1, EN_PASSANT = 2, CASTLING = 3 };
+
+    constexpr PackedMove() noexcept = default;
+    constexpr explicit PackedMove(std::uint16_t raw) noexcept : value(raw) {}
+
+    constexpr PackedMove(Move m) noexcept
+        : value(static_cast<std::uint16_t>(
+            static_cast<int>(m.to()) |
+            (static_cast<int>(m.from()) << 6) |
+            (m.isPromotion() ? ((static_cast<int>(m.promotion()) - KNIGHT) << 12) | (PROMOTION << 14)
+                             : m.isEP() ? EN_PASSANT << 14
+                             : m.isCastle() ? CASTLING << 14 : 0))) {}
+
+    [[nodiscard]] constexpr Square from()      const noexcept { return Square((value >> 6) & 0x3F); }
+    [[nodiscard]] constexpr Square to()        const noexcept { return Square(value & 0x3F); }
+    [[nodiscard]] constexpr int    kind()      const noexcept { return value >> 14; }
+    [[nodiscard]] constexpr Piece  promotion() const noexcept {
+        return kind() == PROMOTION ? static_cast<Piece>(((value >> 12) & 0x03) + KNIGHT) : NO_PIECE;
+    }
+    [[nodiscard]] constexpr bool   isNone()    const noexcept { return value == 0; }
+
+    friend constexpr bool operator==(PackedMove a, PackedMove b) { return a.value == b.value; }
+    friend constexpr bool operator!=(PackedMove a, PackedMove b) { return !(a == b); }
+};
+
+static_assert(sizeof(PackedMove) == 2);
+
+// Long algebraic notation like moveToUci(Move); from, to and promotion are
+// all UCI needs, so no board is required
+inline std::string moveToUci(PackedMove m) {
+    int from = static_cast<int>(m.from());
+    int to = static_cast<int>(m.to());
+    std::string s{
+        static_cast<char>('a' + from % 8), static_cast<char>('1' + from / 8),
+        static_cast<char>('a' + to % 8),   static_cast<char>('1' + to / 8)
+    };
+    if (m.kind() == PackedMove::PROMOTION) {
+        s += "pnbrqk"[m.promotion()];
+    }
+    return s;
+}
@@ -0,0 +1,339 @@
+#include "movegen.hpp"
+
+// Attack tables are produced by constant evaluation, so they live in
+// read-only data and are ready before main() runs. Nothing here is
+// computed at startup and movegen never checks for initialisation.
+
+namespace {
+
+// Magic numbers for rooks
+constexpr uint64_t ROOK_MAGIC_NUMBERS[64] = {
+    0x0080001020400080ULL, 0x0040001000200040ULL, 0x0080081000200080ULL, 0x0080040800100080ULL,
+    0x0080020400080080ULL, 0x0080010200040080ULL, 0x0080008001000200ULL, 0x0080002040800100ULL,
+    0x0000800020400080ULL, 0x0000400020005000ULL, 0x0000801000200080ULL, 0x0000800800100080ULL,
+    0x0000800400080080ULL, 0x0000800200040080ULL, 0x0000800100020080ULL, 0x0000800040800100ULL,
+    0x0000208000400080ULL, 0x0000404000201000ULL, 0x0000808010002000ULL, 0x0000808008001000ULL,
+    0x0000808004000800ULL, 0x0000808002000400ULL, 0x0000010100020004ULL, 0x0000020000408104ULL,
+    0x0000208080004000ULL, 0x0000200040005000ULL, 0x0000100080200080ULL, 0x0000080080100080ULL,
+    0x0000040080080080ULL, 0x0000020080040080ULL, 0x0000010080800200ULL, 0x0000800080004100ULL,
+    0x0000204000800080ULL, 0x0000200040401000ULL, 0x0000100080802000ULL, 0x0000080080801000ULL,
+    0x0000040080800800ULL, 0x0000020080800400ULL, 0x0000020001010004ULL, 0x0000800040800100ULL,
+    0x0000204000808000ULL, 0x0000200040008080ULL, 0x0000100020008080ULL, 0x0000080010008080ULL,
+    0x0000040008008080ULL, 0x0000020004008080ULL, 0x0940020801040010ULL, 0x4086008110420024ULL,
+    0x0100924300220600ULL, 0x1001024002388100ULL, 0x2810008020001080ULL, 0x0018024890018080ULL,
+    0x2001025008000500ULL, 0x0000020004008080ULL, 0x3100800200010080ULL, 0x2000408410450A00ULL,
+    0x0100402100108001ULL, 0x8005130046220082ULL, 0x88448028211201C2ULL, 0x1010080500211001ULL,
+    0x1282002008100402ULL, 0x4302000110080402ULL, 0x0008080100900204ULL, 0x1000110040240B82ULL
+};
+
+// Magic numbers for bishops
+constexpr uint64_t BISHOP_MAGIC_NUMBERS[64] = {
+    0x0002020202020200ULL, 0x0002020202020000ULL, 0x0004010202000000ULL, 0x0004040080000000ULL,
+    0x0001104000000000ULL, 0x0000821040000000ULL, 0x0000410410400000ULL, 0x0000104104104000ULL,
+    0x0000040404040400ULL, 0x0000020202020200ULL, 0x0000040102020000ULL, 0x0000040400800000ULL,
+    0x0000011040000000ULL, 0x0000008210400000ULL, 0x0000004104104000ULL, 0x0000002082082000ULL,
+    0x0004000808080800ULL, 0x0002000404040400ULL, 0x0001000202020200ULL, 0x0000800802004000ULL,
+    0x0000800400A00000ULL, 0x0000200100884000ULL, 0x0000400082082000ULL, 0x0000200041041000ULL,
+    0x0002080010101000ULL, 0x0001040008080800ULL, 0x0000208004010400ULL, 0x0000404004010200ULL,
+    0x0000840000802000ULL, 0x0000404002011000ULL, 0x0000808001041000ULL, 0x0000404000820800ULL,
+    0x0001041000202000ULL, 0x0000820800101000ULL, 0x0000104400080800ULL, 0x0000020080080080ULL,
+    0x0000404040040100ULL, 0x0000808100020100ULL, 0x0001010100020800ULL, 0x0000808080010400ULL,
+    0x0000820820004000ULL, 0x0000410410002000ULL, 0x0000082088001000ULL, 0x0000002011000800ULL,
+    0x0000080100400400ULL, 0x0001010101000200ULL, 0x0002020202000400ULL, 0x0001010101000200ULL,
+    0x0000410410400000ULL, 0x0000208208200000ULL, 0x0000002084100000ULL, 0x0000000020880000ULL,
+    0x0000001002020000ULL, 0x0000040408020000ULL, 0x0004040404040000ULL, 0x0002020202020000ULL,
+    0x0000104104104000ULL, 0x0000002082082000ULL, 0x0000000020841000ULL, 0x0000000000208800ULL,
+    0x0000000010020200ULL, 0x0000000404080200ULL, 0x0000040404040400ULL, 0x0002020202020200ULL
+};
+
+// Magic shifts for rooks
+constexpr int ROOK_MAGIC_SHIFTS[64] = {
+    52, 53, 53, 53, 53, 53, 53, 52,
+    53, 54, 54, 54, 54, 54, 54, 53,
+    53, 54, 54, 54, 54, 54, 54, 53,
+    53, 54, 54, 54, 54, 54, 54, 53,
+    53, 54, 54, 54, 54, 54, 54, 53,
+    53, 54, 54, 54, 54, 54, 54, 53,
+    53, 54, 54, 54, 54, 54, 54, 53,
+    52, 53, 53, 53, 53, 53, 53, 52
+};
+
+// Magic shifts for bishops
+constexpr int BISHOP_MAGIC_SHIFTS[64] = {
+    58, 59, 59, 59, 59, 59, 59, 58,
+    59, 59, 59, 59, 59, 59, 59, 59,
+    59, 59, 57, 57, 57, 57, 59, 59,
+    59, 59, 57, 55, 55, 57, 59, 59,
+    59, 59, 57, 55, 55, 57, 59, 59,
+    59, 59, 57, 57, 57, 57, 59, 59,
+    59, 59, 59, 59, 59, 59, 59, 59,
+    58, 59, 59, 59, 59, 59, 59, 58
+};
+
+// Initialize the attack tables
+
+constexpr bitboard generateKnightAttacks(Square square) {
+    bitboard attacks = 0;
+    int rank = static_cast<int>(square) / 8;
+    int file = static_cast<int>(square) % 8;
+
+    // All possible knight moves
+    const int knightMoves[8][2] = {
+        {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2},
+        {1, -2}, {1, 2}, {2, -1}, {2, 1}
+    };
+
+    for (const auto& move : knightMoves) {
+        int newRank = rank + move[0];
+        int newFile = file + move[1];
+        
+        if (newRank >= 0 && newRank < 8 && newFile >= 0 && newFile < 8) {
+            attacks |= 1ULL << (newRank * 8 + newFile);
+        }
+    }
+
+    return attacks;
+}
+
+constexpr bitboard generateKingAttacks(Square square) {
+    bitboard attacks = 0;
+    int rank = static_cast<int>(square) / 8;
+    int file = static_cast<int>(square) % 8;
+
+    // All possible king moves
+    const int kingMoves[8][2] = {
+        {-1, -1}, {-1, 0}, {-1, 1},
+        {0, -1}, {0, 1},
+        {1, -1}, {1, 0}, {1, 1}
+    };
+
+    for (const auto& move : kingMoves) {
+        int newRank = rank + move[0];
+        int newFile = file + move[1];
+        
+        if (newRank >= 0 && newRank < 8 && newFile >= 0 && newFile < 8) {
+            attacks |= 1ULL << (newRank * 8 + newFile);
+        }
+    }
+
+    return attacks;
+}
+
+constexpr bitboard generatePawnAttacks(Square square, Color color) {
+    bitboard attacks = 0;
+    int rank = static_cast<int>(square) / 8;
+    int file = static_cast<int>(square) % 8;
+
+    if (color == WHITE) {
+        if (rank < 7) {
+            if (file > 0) attacks |= 1ULL << ((rank + 1) * 8 + (file - 1));
+            if (file < 7) attacks |= 1ULL << ((rank + 1) * 8 + (file + 1));
+        }
+    } else {
+        if (rank > 0) {
+            if (file > 0) attacks |= 1ULL << ((rank - 1) * 8 + (file - 1));
+            if (file < 7) attacks |= 1ULL << ((rank - 1) * 8 + (file + 1));
+        }
+    }
+
+    return attacks;
+}
+
+constexpr bitboard generateBishopMask(Square square) {
+    bitboard mask = 0;
+    int rank = static_cast<int>(square) / 8;
+    int file = static_cast<int>(square) % 8;
+
+    // Generate mask for all possible bishop moves
+    for (int r = rank + 1, f = file + 1; r < 7 && f < 7; r++, f++) mask |= 1ULL << (r * 8 + f);
+    for (int r = rank + 1, f = file - 1; r < 7 && f > 0; r++, f--) mask |= 1ULL << (r * 8 + f);
+    for (int r = rank - 1, f = file + 1; r > 0 && f < 7; r--, f++) mask |= 1ULL << (r * 8 + f);
+    for (int r = rank - 1, f = file - 1; r > 0 && f > 0; r--, f--) mask |= 1ULL << (r * 8 + f);
+
+    return mask;
+}
+
+constexpr bitboard generateRookMask(Square square) {
+    bitboard mask = 0;
+    int rank = static_cast<int>(square) / 8;
+    int file = static_cast<int>(square) % 8;
+
+    // Generate mask for all possible rook moves
+    for (int r = rank + 1; r < 7; r++) mask |= 1ULL << (r * 8 + file);
+    for (int r = rank - 1; r > 0; r--) mask |= 1ULL << (r * 8 + file);
+    for (int f = file + 1; f < 7; f++) mask |= 1ULL << (rank * 8 + f);
+    for (int f = file - 1; f > 0; f--) mask |= 1ULL << (rank * 8 + f);
+
+    return mask;
+}
+
+constexpr bitboard calculateBishopAttacks(Square square, bitboard occupancy) {
+    bitboard attacks = 0;
+    int rank = static_cast<int>(square) / 8;
+    int file = static_cast<int>(square) % 8;
+
+    // Generate attacks in all four directions
+    for (int r = rank + 1, f = file + 1; r < 8 && f < 8; r++, f++) {
+        attacks |= 1ULL << (r * 8 + f);
+        if (occupancy & (1ULL << (r * 8 + f))) break;
+    }
+    for (int r = rank + 1, f = file - 1; r < 8 && f >= 0; r++, f--) {
+        attacks |= 1ULL << (r * 8 + f);
+        if (occupancy & (1ULL << (r * 8 + f))) break;
+    }
+    for (int r = rank - 1, f = file + 1; r >= 0 && f < 8; r--, f++) {
+        attacks |= 1ULL << (r * 8 + f);
+        if (occupancy & (1ULL << (r * 8 + f))) break;
+    }
+    for (int r = rank - 1, f = file - 1; r >= 0 && f >= 0; r--, f--) {
+        attacks |= 1ULL << (r * 8 + f);
+        if (occupancy & (1ULL << (r * 8 + f))) break;
+    }
+
+    return attacks;
+}
+
+constexpr bitboard calculateRookAttacks(Square square, bitboard occupancy) {
+    bitboard attacks = 0;
+    int rank = static_cast<int>(square) / 8;
+    int file = static_cast<int>(square) % 8;
+
+    // Generate attacks in all four directions
+    for (int r = rank + 1; r < 8; r++) {
+        attacks |= 1ULL << (r * 8 + file);
+        if (occupancy & (1ULL << (r * 8 + file))) break;
+    }
+    for (int r = rank - 1; r >= 0; r--) {
+        attacks |= 1ULL << (r * 8 + file);
+        if (occupancy & (1ULL << (r * 8 + file))) break;
+    }
+    for (int f = file + 1; f < 8; f++) {
+        attacks |= 1ULL << (rank * 8 + f);
+        if (occupancy & (1ULL << (rank * 8 + f))) break;
+    }
+    for (int f = file - 1; f >= 0; f--) {
+        attacks |= 1ULL << (rank * 8 + f);
+        if (occupancy & (1ULL << (rank * 8 + f))) break;
+    }
+
+    return attacks;
+}
+
+// Table index for the occupancy reached after `subset` carry-rippler
+// steps over the mask. The walk visits subsets in PEXT index order.
+constexpr uint32_t bishopSlot(int square, bitboard occupancy, uint32_t subset) {
+#if USE_PEXT
+    (void)square; (void)occupancy;
+    return subset;
+#else
+    (void)subset;
+    return static_cast<uint32_t>((occupancy * BISHOP_MAGIC_NUMBERS[square]) >> BISHOP_MAGIC_SHIFTS[square]);
+#endif
+}
+
+constexpr uint32_t rookSlot(int square, bitboard occupancy, uint32_t subset) {
+#if USE_PEXT
+    (void)square; (void)occupancy;
+    return subset;
+#else
+    (void)subset;
+    return static_cast<uint32_t>((occupancy * ROOK_MAGIC_NUMBERS[square]) >> ROOK_MAGIC_SHIFTS[square]);
+#endif
+}
+
+template <typename F>
+constexpr std::array<bitboard, 64> perSquare(F f) {
+    std::array<bitboard, 64> table{};
+    for (int square = 0; square < 64; square++) {
+        table[square] = f(static_cast<Square>(square));
+    }
+    return table;
+}
+
+// Each square owns a slice of 2^popcount(mask) entries; bishops come first
+constexpr std::array<uint32_t, 64> sliderOffsets(bool isBishop) {
+    std::array<uint32_t, 64> offsets{};
+    uint32_t offset = 0;
+    for (int square = 0; square < 64; square++) {
+        offset += 1u << __builtin_popcountll(generateBishopMask(static_cast<Square>(square)));
+    }
+    if (isBishop) offset = 0;
+    for (int square = 0; square < 64; square++) {
+        offsets[square] = offset;
+        bitboard mask = isBishop ? generateBishopMask(static_cast<Square>(square)) : generateRookMask(static_cast<Square>(square));
+        offset += 1u << __builtin_popcountll(mask);
+    }
+    return offsets;
+}
+
+constexpr std::array<uint32_t, 64> BISHOP_OFFSET_TABLE = sliderOffsets(true);
+constexpr std::array<uint32_t, 64> ROOK_OFFSET_TABLE = sliderOffsets(false);
+static_assert(ROOK_OFFSET_TABLE[63] + (1u << 12) == MoveGen::SLIDER_TABLE_SIZE);
+
+constexpr std::array<bitboard, MoveGen::SLIDER_TABLE_SIZE> buildSliderAttacks() {
+    std::array<bitboard, MoveGen::SLIDER_TABLE_SIZE> table{};
+    for (int square = 0; square < 64; square++) {
+        Square sq = static_cast<Square>(square);
+
+        // Carry-rippler walk over every subset of the mask
+        bitboard mask = generateBishopMask(sq);
+        bitboard occupancy = 0;
+        for (uint32_t i = 0; i < (1u << __builtin_popcountll(mask)); i++) {
+            table[BISHOP_OFFSET_TABLE[square] + bishopSlot(square, occupancy, i)] = calculateBishopAttacks(sq, occupancy);
+            occupancy = (occupancy - mask) & mask;
+        }
+
+        mask = generateRookMask(sq);
+        occupancy = 0;
+        for (uint32_t i = 0; i < (1u << __builtin_popcountll(mask)); i++) {
+            table[ROOK_OFFSET_TABLE[square] + rookSlot(square, occupancy, i)] = calculateRookAttacks(sq, occupancy);
+            occupancy = (occupancy - mask) & mask;
+        }
+    }
+    return table;
+}
+
+// Between and line tables for every aligned square pair
+constexpr std::array<std::array<bitboard, 64>, 64> buildRayTable(bool between) {
+    std::array<std::array<bitboard, 64>, 64> table{};
+    for (int a = 0; a < 64; a++) {
+        bitboard rookRays = calculateRookAttacks(static_cast<Square>(a), 0);
+        bitboard bishopRays = calculateBishopAttacks(static_cast<Square>(a), 0);
+        for (int b = 0; b < 64; b++) {
+            bitboard ends = (1ULL << a) | (1ULL << b);
+            if (rookRays & (1ULL << b)) {
+                table[a][b] = between
+                    ? calculateRookAttacks(static_cast<Square>(a), 1ULL << b) & calculateRookAttacks(static_cast<Square>(b), 1ULL << a)
+                    : (rookRays & calculateRookAttacks(static_cast<Square>(b), 0)) | ends;
+            } else if (bishopRays & (1ULL << b)) {
+                table[a][b] = between
+                    ? calculateBishopAttacks(static_cast<Square>(a), 1ULL << b) & calculateBishopAttacks(static_cast<Square>(b), 1ULL << a)
+                    : (bishopRays & calculateBishopAttacks(static_cast<Square>(b), 0)) | ends;
+            }
+        }
+    }
+    return table;
+}
+
+} // namespace
+
+constinit const std::array<bitboard, 64> MoveGen::KNIGHT_ATTACKS = perSquare(generateKnightAttacks);
+constinit const std::array<bitboard, 64> MoveGen::KING_ATTACKS = perSquare(generateKingAttacks);
+constinit const std::array<bitboard, 64> MoveGen::PAWN_ATTACKS[2] = {
+    perSquare([](Square sq) { return generatePawnAttacks(sq, WHITE); }),
+    perSquare([](Square sq) { return generatePawnAttacks(sq, BLACK); })
+};
+constinit const std::array<std::array<bitboard, 64>, 64> MoveGen::BETWEEN = buildRayTable(true);
+constinit const std::array<std::array<bitboard, 64>, 64> MoveGen::LINE = buildRayTable(false);
+constinit const std::array<bitboard, 64> MoveGen::BISHOP_MASKS = perSquare(generateBishopMask);
+constinit const std::array<bitboard, 64> MoveGen::ROOK_MASKS = perSquare(generateRookMask);
+constinit const std::array<uint32_t, 64> MoveGen::BISHOP_OFFSETS = BISHOP_OFFSET_TABLE;
+constinit const std::array<uint32_t, 64> MoveGen::ROOK_OFFSETS = ROOK_OFFSET_TABLE;
+constinit const std::array<bitboard, MoveGen::SLIDER_TABLE_SIZE> MoveGen::SLIDER_ATTACKS = buildSliderAttacks();
+
+#if !USE_PEXT
+constinit const std::array<uint64_t, 64> MoveGen::BISHOP_MAGICS = std::to_array(BISHOP_MAGIC_NUMBERS);
+constinit const std::array<uint64_t, 64> MoveGen::ROOK_MAGICS = std::to_array(ROOK_MAGIC_NUMBERS);
+constinit const std::array<int, 64> MoveGen::BISHOP_SHIFTS = std::to_array(BISHOP_MAGIC_SHIFTS);
+constinit const std::array<int, 64> MoveGen::ROOK_SHIFTS = std::to_array(ROOK_MAGIC_SHIFTS);
+#endif
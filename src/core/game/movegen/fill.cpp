@@ -0,0 +1,146 @@
+#include "fill.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define FILL_X86 1
+#else
+#define FILL_X86 0
+#endif
+
+namespace Fill {
+
+#if FILL_X86
+
+namespace {
+
+template<int S>
+inline __m128i shift2(__m128i v) {
+    if constexpr (S > 0) return _mm_slli_epi64(v, S);
+    else return _mm_srli_epi64(v, -S);
+}
+
+// One direction for both colors. SSE2 shifts every lane by the same
+// immediate, which is exactly what two colors sharing a direction need.
+template<int S, bitboard Wrap>
+inline __m128i rayAttacks2(__m128i gen, __m128i empty) {
+    const __m128i wrap = _mm_set1_epi64x(static_cast<long long>(Wrap));
+
+    __m128i pro = _mm_and_si128(empty, wrap);
+    gen = _mm_or_si128(gen, _mm_and_si128(pro, shift2<S>(gen)));
+    pro = _mm_and_si128(pro, shift2<S>(pro));
+    gen = _mm_or_si128(gen, _mm_and_si128(pro, shift2<2 * S>(gen)));
+    pro = _mm_and_si128(pro, shift2<2 * S>(pro));
+    gen = _mm_or_si128(gen, _mm_and_si128(pro, shift2<4 * S>(gen)));
+    return _mm_and_si128(shift2<S>(gen), wrap);
+}
+
+inline __m128i load2(const bitboard v[2]) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+}
+
+inline void store2(bitboard out[2], __m128i v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+}
+
+// Per-lane shift counts for steps of 1, 2 and 4, and the wrap mask. Lane i
+// shifts left by left[i] and right by right[i]; AVX2 turns a count of 64 or
+// more into zero, so each lane keeps only its own direction.
+struct Lanes {
+    alignas(32) uint64_t left1[4], right1[4], left2[4], right2[4], left4[4], right4[4], wrap[4];
+};
+
+// Rook lanes, low to high: N, S, E, W
+constexpr Lanes ROOK_LANES = {
+    {8, 64, 1, 64},  {64, 8, 64, 1},
+    {16, 64, 2, 64}, {64, 16, 64, 2},
+    {32, 64, 4, 64}, {64, 32, 64, 4},
+    {~0ULL, ~0ULL, NOT_A_FILE, NOT_H_FILE}
+};
+
+// Bishop lanes: NE, NW, SE, SW
+constexpr Lanes BISHOP_LANES = {
+    {9, 7, 64, 64},   {64, 64, 7, 9},
+    {18, 14, 64, 64}, {64, 64, 14, 18},
+    {36, 28, 64, 64}, {64, 64, 28, 36},
+    {NOT_A_FILE, NOT_H_FILE, NOT_A_FILE, NOT_H_FILE}
+};
+
+__attribute__((target("avx2")))
+inline __m256i load4(const uint64_t v[4]) {
+    return _mm256_load_si256(reinterpret_cast<const __m256i*>(v));
+}
+
+__attribute__((target("avx2")))
+inline __m256i shiftLanes(__m256i v, const uint64_t left[4], const uint64_t right[4]) {
+    return _mm256_or_si256(_mm256_sllv_epi64(v, load4(left)), _mm256_srlv_epi64(v, load4(right)));
+}
+
+__attribute__((target("avx2")))
+inline bitboard fillLanes(bitboard sliders, bitboard empty, const Lanes& d) {
+    __m256i wrap = load4(d.wrap);
+    __m256i gen = _mm256_set1_epi64x(static_cast<long long>(sliders));
+    __m256i pro = _mm256_and_si256(_mm256_set1_epi64x(static_cast<long long>(empty)), wrap);
+
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, shiftLanes(gen, d.left1, d.right1)));
+    pro = _mm256_and_si256(pro, shiftLanes(pro, d.left1, d.right1));
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, shiftLanes(gen, d.left2, d.right2)));
+    pro = _mm256_and_si256(pro, shiftLanes(pro, d.left2, d.right2));
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, shiftLanes(gen, d.left4, d.right4)));
+    __m256i attacks = _mm256_and_si256(shiftLanes(gen, d.left1, d.right1), wrap);
+
+    // Fold the four lanes into one bitboard
+    __m128i folded = _mm_or_si128(_mm256_castsi256_si128(attacks), _mm256_extracti128_si256(attacks, 1));
+    return static_cast<bitboard>(_mm_cvtsi128_si64(_mm_or_si128(folded, _mm_unpackhi_epi64(folded, folded))));
+}
+
+} // namespace
+
+void rookAttacksSSE2(const bitboard rooks[2], bitboard empty, bitboard out[2]) {
+    __m128i gen = load2(rooks);
+    __m128i e = _mm_set1_epi64x(static_cast<long long>(empty));
+    store2(out, _mm_or_si128(_mm_or_si128(rayAttacks2<8, ~0ULL>(gen, e), rayAttacks2<-8, ~0ULL>(gen, e)),
+                             _mm_or_si128(rayAttacks2<1, NOT_A_FILE>(gen, e), rayAttacks2<-1, NOT_H_FILE>(gen, e))));
+}
+
+void bishopAttacksSSE2(const bitboard bishops[2], bitboard empty, bitboard out[2]) {
+    __m128i gen = load2(bishops);
+    __m128i e = _mm_set1_epi64x(static_cast<long long>(empty));
+    store2(out, _mm_or_si128(_mm_or_si128(rayAttacks2<9, NOT_A_FILE>(gen, e), rayAttacks2<7, NOT_H_FILE>(gen, e)),
+                             _mm_or_si128(rayAttacks2<-7, NOT_A_FILE>(gen, e), rayAttacks2<-9, NOT_H_FILE>(gen, e))));
+}
+
+__attribute__((target("avx2")))
+bitboard rookAttacksAVX2(bitboard rooks, bitboard empty) {
+    return fillLanes(rooks, empty, ROOK_LANES);
+}
+
+__attribute__((target("avx2")))
+bitboard bishopAttacksAVX2(bitboard bishops, bitboard empty) {
+    return fillLanes(bishops, empty, BISHOP_LANES);
+}
+
+bool hasAVX2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+#else
+
+// Portable fallbacks with the same results
+void rookAttacksSSE2(const bitboard rooks[2], bitboard empty, bitboard out[2]) {
+    out[0] = rookAttacks(rooks[0], empty);
+    out[1] = rookAttacks(rooks[1], empty);
+}
+
+void bishopAttacksSSE2(const bitboard bishops[2], bitboard empty, bitboard out[2]) {
+    out[0] = bishopAttacks(bishops[0], empty);
+    out[1] = bishopAttacks(bishops[1], empty);
+}
+
+bitboard rookAttacksAVX2(bitboard rooks, bitboard empty) { return rookAttacks(rooks, empty); }
+bitboard bishopAttacksAVX2(bitboard bishops, bitboard empty) { return bishopAttacks(bishops, empty); }
+bool hasAVX2() { return false; }
+
+#endif
+
+} // namespace Fill
@@ -0,0 +1,62 @@
+#pragma once
+#include "../../../util/util.hpp"
+
+using namespace util;
+
+// Setwise slider attacks by Kogge-Stone occluded fill. Every function takes
+// a set of sliders and the empty squares, and returns the union of their
+// attacks (blockers included) in a fixed number of shifts, however many
+// sliders the set holds.
+namespace Fill {
+
+constexpr bitboard NOT_A_FILE = ~0x0101010101010101ULL;
+constexpr bitboard NOT_H_FILE = ~0x8080808080808080ULL;
+
+// Positive S shifts towards h8, negative towards a1
+template<int S>
+constexpr bitboard shift(bitboard b) {
+    return S > 0 ? b << S : b >> -S;
+}
+
+// Floods gen along one direction through the propagator set in three steps
+// of 1, 2 and 4, then steps once more to reach the first blocker. Wrap is
+// the set of squares a step in this direction may land on.
+template<int S, bitboard Wrap>
+constexpr bitboard rayAttacks(bitboard gen, bitboard empty) {
+    bitboard pro = empty & Wrap;
+    gen |= pro & shift<S>(gen);
+    pro &= shift<S>(pro);
+    gen |= pro & shift<2 * S>(gen);
+    pro &= shift<2 * S>(pro);
+    gen |= pro & shift<4 * S>(gen);
+    return shift<S>(gen) & Wrap;
+}
+
+constexpr bitboard rookAttacks(bitboard rooks, bitboard empty) {
+    return rayAttacks<8, ~0ULL>(rooks, empty)
+         | rayAttacks<-8, ~0ULL>(rooks, empty)
+         | rayAttacks<1, NOT_A_FILE>(rooks, empty)
+         | rayAttacks<-1, NOT_H_FILE>(rooks, empty);
+}
+
+constexpr bitboard bishopAttacks(bitboard bishops, bitboard empty) {
+    return rayAttacks<9, NOT_A_FILE>(bishops, empty)
+         | rayAttacks<7, NOT_H_FILE>(bishops, empty)
+         | rayAttacks<-7, NOT_A_FILE>(bishops, empty)
+         | rayAttacks<-9, NOT_H_FILE>(bishops, empty);
+}
+
+// SSE2: each 128-bit register holds the same direction for both colors,
+// so one pass yields the rook (or bishop) maps of white and black.
+void rookAttacksSSE2(const bitboard rooks[2], bitboard empty, bitboard out[2]);
+void bishopAttacksSSE2(const bitboard bishops[2], bitboard empty, bitboard out[2]);
+
+// AVX2: the four ray directions run in parallel lanes, using per-lane
+// variable shifts. Only call when hasAVX2() is true.
+bitboard rookAttacksAVX2(bitboard rooks, bitboard empty);
+bitboard bishopAttacksAVX2(bitboard bishops, bitboard empty);
+
+// Runtime check, so a default build can use AVX2 when the CPU has it
+bool hasAVX2();
+
+} // namespace Fill
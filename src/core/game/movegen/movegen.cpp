@@ -1,804 +1,742 @@
 #include "movegen.hpp"
+#include "fill.hpp"
 #include <array>
+#include <cassert>
 #include <memory>
 #include <iostream>
 
-std::vector<Move> MoveGen::generatePseudoLegalMoves(const Board& board) {
-    // Ensure attack tables are initialized
-    if (!initialized) {
-        initializeAttackTables();
+// The side to move is resolved once here; everything below is specialized per color
+#define DISPATCH(Type, board, moves) \
+    ((board).getSideToMove() == WHITE ? generate<Type, WHITE>(board, moves) : generate<Type, BLACK>(board, moves))
+
+void MoveGen::generateLegalMoves(const Board& board, MoveList& moves) {
+    DISPATCH(LEGAL, board, moves);
+}
+
+void MoveGen::generateCaptures(const Board& board, MoveList& moves) {
+    DISPATCH(CAPTURES, board, moves);
+}
+
+void MoveGen::generateQuiets(const Board& board, MoveList& moves) {
+    DISPATCH(QUIETS, board, moves);
+}
+
+void MoveGen::generateEvasions(const Board& board, MoveList& moves) {
+    assert(inCheck(board));
+    DISPATCH(EVASIONS, board, moves);
+}
+
+void MoveGen::generateQuietChecks(const Board& board, MoveList& moves) {
+    DISPATCH(QUIET_CHECKS, board, moves);
+}
+
+#undef DISPATCH
+
+int MoveGen::countLegalMoves(const Board& board) {
+    std::array<int, 6> perPiece;
+    return countMobility(board, perPiece);
+}
+
+int MoveGen::countMobility(const Board& board, std::array<int, 6>& perPiece) {
+    return board.getSideToMove() == WHITE ? countMoves<WHITE>(board, perPiece) : countMoves<BLACK>(board, perPiece);
+}
+
+template<Color Us>
+MoveGen::LegalMasks MoveGen::legalMasks(const Board& board) {
+    const AttackInfo& info = legalityInfo<Us>(board);
+
+    LegalMasks masks;
+    masks.kingSq = static_cast<Square>(__builtin_ctzll(board.king(Us)));
+    masks.checkers = info.checkers;
+    masks.pinned = info.pinned[Us];
+    masks.enemyAttacks = info.kingDanger;
+    masks.target = ~board.occupancy(Us);
+
+    // A single checker must be captured or blocked; in double check nothing but the king moves
+    if (!masks.checkers) {
+        masks.checkMask = ~0ULL;
+    } else if (!(masks.checkers & (masks.checkers - 1))) {
+        Square checkerSq = static_cast<Square>(__builtin_ctzll(masks.checkers));
+        masks.checkMask = BETWEEN[static_cast<int>(masks.kingSq)][static_cast<int>(checkerSq)] | masks.checkers;
+    } else {
+        masks.checkMask = 0;
     }
-    
-    std::vector<Move> moves;
-    moves.reserve(218); 
-    
-    // Generate moves for each piece type
-    generatePawnMoves(board, moves);
-    generateKnightMoves(board, moves);
-    generateBishopMoves(board, moves);
-    generateRookMoves(board, moves);
-    generateQueenMoves(board, moves);
-    generateKingMoves(board, moves);
-    
-    // Generate special moves
-    generateCastlingMoves(board, moves);
-    generateEnPassantMoves(board, moves);
-    
-    return moves;
+    return masks;
 }
 
-void MoveGen::generatePawnMoves(const Board& board, std::vector<Move>& moves) {
-    Color side = board.getSideToMove();
-    bitboard pawns = board.pawns(side);
-    bitboard occAll = board.allOccupancy();
-    
-    // For each pawn on the board
-    while (pawns) {
-        Square from = static_cast<Square>(__builtin_ctzll(pawns));
-        int rank = static_cast<int>(from) / 8;
-        int file = static_cast<int>(from) % 8;
-        
-        // Forward moves
-        Square forwardOne = static_cast<Square>(static_cast<int>(from) + (side == WHITE ? 8 : -8));
-        if (static_cast<int>(forwardOne) >= 0 && static_cast<int>(forwardOne) < 64 && !(occAll & (1ULL << static_cast<int>(forwardOne)))) {
-            // Check if this is a promotion
-            if ((side == WHITE && rank == 6) || (side == BLACK && rank == 1)) {
-                // Add promotion moves for all piece types
-                moves.push_back(Move(from, forwardOne, static_cast<Piece>(PAWN), NO_PIECE, QUEEN));
-                moves.push_back(Move(from, forwardOne, static_cast<Piece>(PAWN), NO_PIECE, ROOK));
-                moves.push_back(Move(from, forwardOne, static_cast<Piece>(PAWN), NO_PIECE, BISHOP));
-                moves.push_back(Move(from, forwardOne, static_cast<Piece>(PAWN), NO_PIECE, KNIGHT));
-            } else {
-                moves.push_back(Move(from, forwardOne, static_cast<Piece>(PAWN)));
-                
-                // Two square move from starting position
-                if ((side == WHITE && rank == 1) || (side == BLACK && rank == 6)) {
-                    Square forwardTwo = static_cast<Square>(static_cast<int>(from) + (side == WHITE ? 16 : -16));
-                    Square via = static_cast<Square>(static_cast<int>(from) + (side == WHITE ? 8 : -8));
-                    if (!(occAll & (1ULL << static_cast<int>(via))) && !(occAll & (1ULL << static_cast<int>(forwardTwo)))) {
-                        moves.push_back(Move(from, forwardTwo, static_cast<Piece>(PAWN), NO_PIECE, NO_PIECE, Move::DPUSH));
-                    }
-                }
-            }
-        }
-        
-        // Capture moves
-        bitboard attacks = PAWN_ATTACKS[side][static_cast<int>(from)];
-        while (attacks) {
-            Square to = static_cast<Square>(__builtin_ctzll(attacks));
-            Piece captured = board.pieceAt(to);
-            
-            if (captured != NO_PIECE) {
-                // Normalize captured piece to white piece index (0-5)
-                Piece normalizedCaptured = static_cast<Piece>(static_cast<int>(captured) % 6);
-                
-                // Check if this is a promotion
-                if ((side == WHITE && rank == 6) || (side == BLACK && rank == 1)) {
-                    // Add promotion moves for all piece types
-                    moves.push_back(Move(from, to, static_cast<Piece>(PAWN), normalizedCaptured, QUEEN));
-                    moves.push_back(Move(from, to, static_cast<Piece>(PAWN), normalizedCaptured, ROOK));
-                    moves.push_back(Move(from, to, static_cast<Piece>(PAWN), normalizedCaptured, BISHOP));
-                    moves.push_back(Move(from, to, static_cast<Piece>(PAWN), normalizedCaptured, KNIGHT));
-                } else {
-                    moves.push_back(Move(from, to, static_cast<Piece>(PAWN), normalizedCaptured));
-                }
-            }
-            
-            attacks &= attacks - 1;
-        }
-        
-        pawns &= pawns - 1;
+template<MoveGen::GenType Type, Color Us>
+void MoveGen::generate(const Board& board, MoveList& moves) {
+    constexpr Color Them = Us == WHITE ? BLACK : WHITE;
+    LegalMasks masks = legalMasks<Us>(board);
+
+    // Restrict destinations up front instead of filtering the list afterwards
+    if constexpr (Type == CAPTURES) {
+        masks.target = board.occupancy(Them);
+    } else if constexpr (Type == QUIETS || Type == QUIET_CHECKS) {
+        masks.target = ~board.allOccupancy();
+    }
+
+    if constexpr (Type == QUIET_CHECKS) {
+        Square enemyKingSq = static_cast<Square>(__builtin_ctzll(board.king(Them)));
+        bitboard bishopChecks = getBishopAttacks(enemyKingSq, board.allOccupancy());
+        bitboard rookChecks = getRookAttacks(enemyKingSq, board.allOccupancy());
+
+        masks.enemyKingSq = enemyKingSq;
+        masks.discoverers = sliderBlockers(board, enemyKingSq, Us) & board.occupancy(Us);
+        masks.checkSquares[PAWN] = PAWN_ATTACKS[Them][static_cast<int>(enemyKingSq)];
+        masks.checkSquares[KNIGHT] = KNIGHT_ATTACKS[static_cast<int>(enemyKingSq)];
+        masks.checkSquares[BISHOP] = bishopChecks;
+        masks.checkSquares[ROOK] = rookChecks;
+        masks.checkSquares[QUEEN] = bishopChecks | rookChecks;
+        masks.checkSquares[KING] = 0;
+    }
+
+    generateKingMoves<Type>(board, moves, masks);
+
+    // In double check only the king can move
+    if (!masks.checkMask) {
+        return;
+    }
+
+    // Generate moves for each piece type
+    generatePawnMoves<Type, Us>(board, moves, masks);
+    generateKnightMoves<Type, Us>(board, moves, masks);
+    generateBishopMoves<Type, Us>(board, moves, masks);
+    generateRookMoves<Type, Us>(board, moves, masks);
+    generateQueenMoves<Type, Us>(board, moves, masks);
+
+    // Generate special moves
+    if constexpr (Type == QUIETS || Type == LEGAL) {
+        generateCastlingMoves<Us>(board, moves, masks);
+    }
+    if constexpr (Type == CAPTURES || Type == EVASIONS || Type == LEGAL) {
+        generateEnPassantMoves<Us>(board, moves, masks);
     }
 }
 
-void MoveGen::generateKnightMoves(const Board& board, std::vector<Move>& moves) {
-    Color side = board.getSideToMove();
-    bitboard knights = board.knights(side);
-    
+// Same legality rules as generate<LEGAL>, but every target set is popcounted
+// instead of serialized into moves
+template<Color Us>
+int MoveGen::countMoves(const Board& board, std::array<int, 6>& perPiece) {
+    constexpr Color    Them    = Us == WHITE ? BLACK : WHITE;
+    constexpr int      Up      = Us == WHITE ? 8 : -8;
+    constexpr int      UpLeft  = Us == WHITE ? 7 : -9;
+    constexpr int      UpRight = Us == WHITE ? 9 : -7;
+    constexpr bitboard Rank3   = Board::RankBB[Us == WHITE ? 2 : 5];
+    constexpr bitboard Rank7   = Board::RankBB[Us == WHITE ? 6 : 1];
+    constexpr bitboard Rank8   = Board::RankBB[Us == WHITE ? 7 : 0];
+
+    LegalMasks masks = legalMasks<Us>(board);
+    int ksq = static_cast<int>(masks.kingSq);
+    bitboard occAll = board.allOccupancy();
+    bitboard targets = masks.target & masks.checkMask;
+    perPiece.fill(0);
+
+    perPiece[KING] = __builtin_popcountll(KING_ATTACKS[ksq] & masks.target & ~masks.enemyAttacks);
+    if (!masks.checkMask) {
+        return perPiece[KING];
+    }
+
+    // Pawns: the same setwise masks as generatePawnMoves, promotions count four times
+    bitboard pawns = board.pawns(Us);
+    bitboard empty = ~occAll;
+    bitboard pinnedPawns = pawns & masks.pinned;
+    bitboard pushers = (pawns & ~masks.pinned) | (pinnedPawns & Board::FileBB[ksq % 8]);
+    bitboard capturers = pawns & ~masks.pinned;
+    bitboard enemies = board.occupancy(Them) & masks.checkMask;
+
+    bitboard single = shift<Up>(pushers) & empty;
+    bitboard dbl = shift<Up>(single & Rank3) & empty & masks.checkMask;
+    single &= masks.checkMask;
+    bitboard captures = shift<UpLeft>(capturers) & enemies;
+    bitboard capturesRight = shift<UpRight>(capturers) & enemies;
+
+    perPiece[PAWN] = __builtin_popcountll(single & ~Rank8) + 4 * __builtin_popcountll(single & Rank8)
+                   + __builtin_popcountll(dbl)
+                   + __builtin_popcountll(captures & ~Rank8) + 4 * __builtin_popcountll(captures & Rank8)
+                   + __builtin_popcountll(capturesRight & ~Rank8) + 4 * __builtin_popcountll(capturesRight & Rank8);
+
+    bitboard diagonalPinned = pinnedPawns & ~Board::FileBB[ksq % 8];
+    while (diagonalPinned) {
+        int from = __builtin_ctzll(diagonalPinned);
+        bitboard attacks = PAWN_ATTACKS[Us][from] & enemies & LINE[ksq][from];
+        perPiece[PAWN] += __builtin_popcountll(attacks) * (((1ULL << from) & Rank7) ? 4 : 1);
+        diagonalPinned &= diagonalPinned - 1;
+    }
+    perPiece[PAWN] += __builtin_popcountll(enPassantCapturers<Us>(board, masks));
+
+    // Pieces: a pinned piece keeps only the part of its targets on the pin line
+    bitboard knights = board.knights(Us) & ~masks.pinned;
     while (knights) {
-        Square from = static_cast<Square>(__builtin_ctzll(knights));
-        bitboard attacks = KNIGHT_ATTACKS[static_cast<int>(from)] & ~board.occupancy(side);
-        
-        while (attacks) {
-            Square to = static_cast<Square>(__builtin_ctzll(attacks));
-            Piece captured = board.pieceAt(to);
-            
-            if (captured != NO_PIECE) {
-                // Normalize captured piece to white piece index (0-5)
-                Piece normalizedCaptured = static_cast<Piece>(static_cast<int>(captured) % 6);
-                moves.push_back(Move(from, to, static_cast<Piece>(KNIGHT), normalizedCaptured));
-            } else {
-                moves.push_back(Move(from, to, static_cast<Piece>(KNIGHT)));
-            }
-            
-            attacks &= attacks - 1;
-        }
-        
+        perPiece[KNIGHT] += __builtin_popcountll(KNIGHT_ATTACKS[__builtin_ctzll(knights)] & targets);
         knights &= knights - 1;
     }
-}
 
-void MoveGen::generateBishopMoves(const Board& board, std::vector<Move>& moves) {
-    Color side = board.getSideToMove();
-    bitboard bishops = board.bishops(side);
-    
+    bitboard bishops = board.bishops(Us);
     while (bishops) {
         Square from = static_cast<Square>(__builtin_ctzll(bishops));
-        bitboard attacks = getBishopAttacks(from, board.allOccupancy()) & ~board.occupancy(side);
-        
-        while (attacks) {
-            Square to = static_cast<Square>(__builtin_ctzll(attacks));
-            Piece captured = board.pieceAt(to);
-            
-            if (captured != NO_PIECE) {
-                // Normalize captured piece to white piece index (0-5)
-                Piece normalizedCaptured = static_cast<Piece>(static_cast<int>(captured) % 6);
-                moves.push_back(Move(from, to, static_cast<Piece>(BISHOP), normalizedCaptured));
-            } else {
-                moves.push_back(Move(from, to, static_cast<Piece>(BISHOP)));
-            }
-            
-            attacks &= attacks - 1;
-        }
-        
+        perPiece[BISHOP] += __builtin_popcountll(pieceTargets<LEGAL>(masks, BISHOP, from, getBishopAttacks(from, occAll)));
         bishops &= bishops - 1;
     }
-}
 
-void MoveGen::generateRookMoves(const Board& board, std::vector<Move>& moves) {
-    Color side = board.getSideToMove();
-    bitboard rooks = board.rooks(side);
-    
+    bitboard rooks = board.rooks(Us);
     while (rooks) {
         Square from = static_cast<Square>(__builtin_ctzll(rooks));
-        bitboard attacks = getRookAttacks(from, board.allOccupancy()) & ~board.occupancy(side);
-        
-        while (attacks) {
-            Square to = static_cast<Square>(__builtin_ctzll(attacks));
-            Piece captured = board.pieceAt(to);
-            
-            if (captured != NO_PIECE) {
-                // Normalize captured piece to white piece index (0-5)
-                Piece normalizedCaptured = static_cast<Piece>(static_cast<int>(captured) % 6);
-                moves.push_back(Move(from, to, static_cast<Piece>(ROOK), normalizedCaptured));
-            } else {
-                moves.push_back(Move(from, to, static_cast<Piece>(ROOK)));
-            }
-            
-            attacks &= attacks - 1;
-        }
-        
+        perPiece[ROOK] += __builtin_popcountll(pieceTargets<LEGAL>(masks, ROOK, from, getRookAttacks(from, occAll)));
         rooks &= rooks - 1;
     }
-}
 
-void MoveGen::generateQueenMoves(const Board& board, std::vector<Move>& moves) {
-    Color side = board.getSideToMove();
-    bitboard queens = board.queens(side);
-    
+    bitboard queens = board.queens(Us);
     while (queens) {
         Square from = static_cast<Square>(__builtin_ctzll(queens));
-        bitboard attacks = (getRookAttacks(from, board.allOccupancy()) | getBishopAttacks(from, board.allOccupancy())) & ~board.occupancy(side);
-        
-        while (attacks) {
-            Square to = static_cast<Square>(__builtin_ctzll(attacks));
-            Piece captured = board.pieceAt(to);
-            
-            if (captured != NO_PIECE) {
-                // Normalize captured piece to white piece index (0-5)
-                Piece normalizedCaptured = static_cast<Piece>(static_cast<int>(captured) % 6);
-                moves.push_back(Move(from, to, static_cast<Piece>(QUEEN), normalizedCaptured));
-            } else {
-                moves.push_back(Move(from, to, static_cast<Piece>(QUEEN)));
-            }
-            
-            attacks &= attacks - 1;
-        }
-        
+        bitboard attacks = getRookAttacks(from, occAll) | getBishopAttacks(from, occAll);
+        perPiece[QUEEN] += __builtin_popcountll(pieceTargets<LEGAL>(masks, QUEEN, from, attacks));
         queens &= queens - 1;
     }
+
+    perPiece[KING] += __builtin_popcountll(castlingSides<Us>(board, masks));
+
+    return perPiece[PAWN] + perPiece[KNIGHT] + perPiece[BISHOP] + perPiece[ROOK] + perPiece[QUEEN] + perPiece[KING];
 }
 
-void MoveGen::generateKingMoves(const Board& board, std::vector<Move>& moves) {
-    Color side = board.getSideToMove();
-    bitboard king = board.king(side);
-    
-    if (king) {
-        Square from = static_cast<Square>(__builtin_ctzll(king));
-        bitboard enemyAtt = allEnemyAttacks(board, side);
-        bitboard attacks = KING_ATTACKS[static_cast<int>(from)] & ~board.occupancy(side) & ~enemyAtt;
-        
-        while (attacks) {
-            Square to = static_cast<Square>(__builtin_ctzll(attacks));
-            Piece captured = board.pieceAt(to);
-            
-            if (captured != NO_PIECE) {
-                // Normalize captured piece to white piece index (0-5)
-                Piece normalizedCaptured = static_cast<Piece>(static_cast<int>(captured) % 6);
-                moves.push_back(Move(from, to, static_cast<Piece>(KING), normalizedCaptured));
-            } else {
-                moves.push_back(Move(from, to, static_cast<Piece>(KING)));
-            }
-            
-            attacks &= attacks - 1;
-        }
+template<MoveGen::GenType Type>
+bitboard MoveGen::pieceTargets(const LegalMasks& masks, Piece pt, Square from, bitboard attacks) {
+    bitboard targets = attacks & masks.target & masks.checkMask;
+    if (masks.pinned & (1ULL << static_cast<int>(from))) {
+        targets &= LINE[static_cast<int>(masks.kingSq)][static_cast<int>(from)];
     }
+
+    // Check directly, or step off the line a friendly slider sees the king through
+    if constexpr (Type == QUIET_CHECKS) {
+        bitboard discovered = (masks.discoverers & (1ULL << static_cast<int>(from)))
+                            ? ~LINE[static_cast<int>(masks.enemyKingSq)][static_cast<int>(from)] : 0;
+        targets &= masks.checkSquares[pt] | discovered;
+    }
+    return targets;
 }
 
-void MoveGen::generateCastlingMoves(const Board& board, std::vector<Move>& moves) {
-    Color side = board.getSideToMove();
-    Color enemy = static_cast<Color>(!side);
-    bitboard occAll = board.allOccupancy();
-    
-    // Define castling paths
-    const Square KS_PASS[2][2] = {{F1, G1}, {F8, G8}};
-    const Square QS_PASS[2][3] = {{D1, C1, B1}, {D8, C8, B8}};
-    
-    // Check kingside castling
-    if (board.hasCastlingRight(side, KINGSIDE)) {
-        Square kingFrom = side == WHITE ? E1 : E8;
-        Square kingTo = side == WHITE ? G1 : G8;
-        Square rookFrom = side == WHITE ? H1 : H8;
-        
-        // Verify rook is present
-        Piece rookPiece = static_cast<Piece>(ROOK + (side * 6));
-        if (board.pieceAt(rookFrom) != rookPiece) {
-            // Skip to queenside check
+void MoveGen::addMoves(const Board& board, MoveList& moves, Square from, bitboard targets, Piece pt) {
+    while (targets) {
+        Square to = static_cast<Square>(__builtin_ctzll(targets));
+        Piece captured = board.pieceAt(to);
+
+        if (captured != NO_PIECE) {
+            // Normalize captured piece to white piece index (0-5)
+            Piece normalizedCaptured = static_cast<Piece>(static_cast<int>(captured) % 6);
+            moves.push(Move(from, to, pt, normalizedCaptured));
         } else {
-            // Check if squares between king and rook are empty
-            bool squaresEmpty = true;
-            for (int i = 0; i < 2; i++) {
-                if (occAll & (1ULL << static_cast<int>(KS_PASS[side][i]))) {
-                    squaresEmpty = false;
-                    break;
-                }
-            }
-            
-            if (squaresEmpty) {
-                // Check if king and squares it moves through are not attacked
-                bool squaresSafe = !isSquareAttacked(board, kingFrom, enemy);
-                if (squaresSafe) {
-                    for (int i = 0; i < 2; i++) {
-                        if (isSquareAttacked(board, KS_PASS[side][i], enemy)) {
-                            squaresSafe = false;
-                            break;
-                        }
-                    }
-                }
-                
-                if (squaresSafe) {
-                    moves.push_back(Move(kingFrom, kingTo, KING, NO_PIECE, NO_PIECE, Move::CASTLE));
-                }
-            }
+            moves.push(Move(from, to, pt));
         }
+
+        targets &= targets - 1;
     }
-    
-    // Check queenside castling
-    if (board.hasCastlingRight(side, QUEENSIDE)) {
-        Square kingFrom = side == WHITE ? E1 : E8;
-        Square kingTo = side == WHITE ? C1 : C8;
-        Square rookFrom = side == WHITE ? A1 : A8;
-        
-        // Verify rook is present
-        Piece rookPiece = static_cast<Piece>(ROOK + (side * 6));
-        if (board.pieceAt(rookFrom) != rookPiece) {
-            return;
-        }
-        
-        // Check if squares between king and rook are empty
-        bool squaresEmpty = true;
-        for (int i = 0; i < 3; i++) {
-            if (occAll & (1ULL << static_cast<int>(QS_PASS[side][i]))) {
-                squaresEmpty = false;
-                break;
-            }
+}
+
+// Emits one pawn move per target square, `Delta` behind which is the origin
+template<int Delta>
+void MoveGen::addPawnMoves(const Board& board, MoveList& moves, bitboard targets, int flags) {
+    while (targets) {
+        int to = __builtin_ctzll(targets);
+        Piece captured = board.pieceAt(static_cast<Square>(to));
+        Piece normalizedCaptured = captured == NO_PIECE ? NO_PIECE : static_cast<Piece>(static_cast<int>(captured) % 6);
+        moves.push(Move(static_cast<Square>(to - Delta), static_cast<Square>(to), PAWN, normalizedCaptured, NO_PIECE, flags));
+        targets &= targets - 1;
+    }
+}
+
+template<int Delta>
+void MoveGen::addPromotions(const Board& board, MoveList& moves, bitboard targets) {
+    while (targets) {
+        int to = __builtin_ctzll(targets);
+        Square from = static_cast<Square>(to - Delta);
+        Piece captured = board.pieceAt(static_cast<Square>(to));
+        Piece normalizedCaptured = captured == NO_PIECE ? NO_PIECE : static_cast<Piece>(static_cast<int>(captured) % 6);
+
+        // Add promotion moves for all piece types
+        moves.push(Move(from, static_cast<Square>(to), PAWN, normalizedCaptured, QUEEN));
+        moves.push(Move(from, static_cast<Square>(to), PAWN, normalizedCaptured, ROOK));
+        moves.push(Move(from, static_cast<Square>(to), PAWN, normalizedCaptured, BISHOP));
+        moves.push(Move(from, static_cast<Square>(to), PAWN, normalizedCaptured, KNIGHT));
+        targets &= targets - 1;
+    }
+}
+
+template<MoveGen::GenType Type, Color Us>
+void MoveGen::generatePawnMoves(const Board& board, MoveList& moves, const LegalMasks& masks) {
+    // Captures, en passant and all promotions belong to the capture stage
+    constexpr bool emitCaptures = Type == CAPTURES || Type == EVASIONS || Type == LEGAL;
+    constexpr bool emitPushes = Type != CAPTURES;
+
+    constexpr Color    Them      = Us == WHITE ? BLACK : WHITE;
+    constexpr int      Up        = Us == WHITE ? 8 : -8;
+    constexpr int      UpLeft    = Us == WHITE ? 7 : -9;
+    constexpr int      UpRight   = Us == WHITE ? 9 : -7;
+    constexpr bitboard Rank3     = Board::RankBB[Us == WHITE ? 2 : 5];
+    constexpr bitboard Rank7     = Board::RankBB[Us == WHITE ? 6 : 1];
+    constexpr bitboard Rank8     = Board::RankBB[Us == WHITE ? 7 : 0];
+
+    bitboard pawns = board.pawns(Us);
+    bitboard empty = ~board.allOccupancy();
+    int kingFile = static_cast<int>(masks.kingSq) % 8;
+
+    // A pinned pawn may still push along a file pin. Diagonal pins are rare
+    // and handled one pawn at a time below.
+    bitboard pinnedPawns = pawns & masks.pinned;
+    bitboard pushers = (pawns & ~masks.pinned) | (pinnedPawns & Board::FileBB[kingFile]);
+    bitboard capturers = pawns & ~masks.pinned;
+
+    if constexpr (emitPushes) {
+        bitboard single = shift<Up>(pushers & ~Rank7) & empty;
+        bitboard dbl = shift<Up>(single & Rank3) & empty;
+        single &= masks.checkMask;
+        dbl &= masks.checkMask;
+
+        // Direct checks, or a push that uncovers a slider (any push leaves a non-file line)
+        if constexpr (Type == QUIET_CHECKS) {
+            bitboard discovered = pushers & masks.discoverers
+                                & ~Board::FileBB[static_cast<int>(masks.enemyKingSq) % 8];
+            single &= masks.checkSquares[PAWN] | shift<Up>(discovered);
+            dbl &= masks.checkSquares[PAWN] | shift<Up>(shift<Up>(discovered));
         }
-        
-        if (squaresEmpty) {
-            // Check if king and squares it moves through are not attacked
-            bool squaresSafe = !isSquareAttacked(board, kingFrom, enemy);
-            if (squaresSafe) {
-                for (int i = 0; i < 3; i++) {
-                    if (isSquareAttacked(board, QS_PASS[side][i], enemy)) {
-                        squaresSafe = false;
-                        break;
-                    }
+
+        addPawnMoves<Up>(board, moves, single, Move::QUIET);
+        addPawnMoves<2 * Up>(board, moves, dbl, Move::DPUSH);
+    }
+
+    if constexpr (emitCaptures) {
+        bitboard enemies = board.occupancy(Them) & masks.checkMask;
+
+        bitboard promoPushes = shift<Up>(pushers & Rank7) & empty & masks.checkMask;
+        bitboard left = shift<UpLeft>(capturers) & enemies;
+        bitboard right = shift<UpRight>(capturers) & enemies;
+
+        addPromotions<Up>(board, moves, promoPushes);
+        addPromotions<UpLeft>(board, moves, left & Rank8);
+        addPromotions<UpRight>(board, moves, right & Rank8);
+        addPawnMoves<UpLeft>(board, moves, left & ~Rank8, Move::QUIET);
+        addPawnMoves<UpRight>(board, moves, right & ~Rank8, Move::QUIET);
+
+        // Pawns pinned on a diagonal can only take the pinner
+        bitboard diagonalPinned = pinnedPawns & ~Board::FileBB[kingFile];
+        while (diagonalPinned) {
+            int from = __builtin_ctzll(diagonalPinned);
+            bitboard attacks = PAWN_ATTACKS[Us][from] & enemies & LINE[static_cast<int>(masks.kingSq)][from];
+            if (attacks) {
+                Square to = static_cast<Square>(__builtin_ctzll(attacks));
+                Piece normalizedCaptured = static_cast<Piece>(static_cast<int>(board.pieceAt(to)) % 6);
+                if ((1ULL << from) & Rank7) {
+                    moves.push(Move(static_cast<Square>(from), to, PAWN, normalizedCaptured, QUEEN));
+                    moves.push(Move(static_cast<Square>(from), to, PAWN, normalizedCaptured, ROOK));
+                    moves.push(Move(static_cast<Square>(from), to, PAWN, normalizedCaptured, BISHOP));
+                    moves.push(Move(static_cast<Square>(from), to, PAWN, normalizedCaptured, KNIGHT));
+                } else {
+                    moves.push(Move(static_cast<Square>(from), to, PAWN, normalizedCaptured));
                 }
             }
-            
-            if (squaresSafe) {
-                moves.push_back(Move(kingFrom, kingTo, KING, NO_PIECE, NO_PIECE, Move::CASTLE));
-            }
+            diagonalPinned &= diagonalPinned - 1;
         }
     }
 }
 
-void MoveGen::generateEnPassantMoves(const Board& board, std::vector<Move>& moves) {
-    int epFile = board.getEpFile();
-    if (epFile == -1) return;
-    
-    Color side = board.getSideToMove();
-    Piece pawnPiece = static_cast<Piece>(PAWN + (side * 6));
-    int epRank = side == WHITE ? 4 : 3;  // En passant rank is always 3 for white, 4 for black
-    
-    // Check adjacent files for pawns that can capture en passant
-    for (int fileOffset : {-1, 1}) {
-        int file = epFile + fileOffset;
-        if (file < 0 || file > 7) continue;
-        
-        Square from = static_cast<Square>(epRank * 8 + file);
-        if (board.pieceAt(from) != pawnPiece) continue;
-        
-        Square epSquare = static_cast<Square>(epRank * 8 + epFile);
-        
-        // Create a test board to verify king safety
-        Board testBoard = board;
-        Move epMove(from, epSquare, PAWN, NO_PIECE, NO_PIECE, Move::EP);
-        testBoard.makeMove(epMove);
-        
-        // Get king's square after the move
-        Piece kingPiece = static_cast<Piece>(KING + (side * 6));
-        bitboard kingBB = testBoard.getPieceBB(kingPiece);
-        Square kingSquare = static_cast<Square>(__builtin_ctzll(kingBB));
-        
-        // Only add the move if it doesn't leave the king in check
-        if (!isSquareAttacked(testBoard, kingSquare, static_cast<Color>(!side))) {
-            moves.push_back(epMove);
-        }
+template<MoveGen::GenType Type, Color Us>
+void MoveGen::generateKnightMoves(const Board& board, MoveList& moves, const LegalMasks& masks) {
+    // A pinned knight can never stay on the pin ray
+    bitboard knights = board.knights(Us) & ~masks.pinned;
+
+    while (knights) {
+        Square from = static_cast<Square>(__builtin_ctzll(knights));
+        addMoves(board, moves, from, pieceTargets<Type>(masks, KNIGHT, from, KNIGHT_ATTACKS[static_cast<int>(from)]), KNIGHT);
+        knights &= knights - 1;
     }
 }
 
-bool MoveGen::isSquareAttacked(const Board& board, Square square, Color byColor) {
-    // Check for pawn attacks
-    bitboard pawns = byColor == WHITE ? board.getPieceBB(static_cast<Piece>(PAWN)) : board.getPieceBB(static_cast<Piece>(PAWN + 6));
-    bitboard pawnAttacks = PAWN_ATTACKS[byColor][static_cast<int>(square)];
-    if (pawnAttacks & pawns) {
-        return true;
-    }
-    
-    // Check for knight attacks
-    bitboard knights = byColor == WHITE ? board.getPieceBB(static_cast<Piece>(KNIGHT)) : board.getPieceBB(static_cast<Piece>(KNIGHT + 6));
-    bitboard knightAttacks = KNIGHT_ATTACKS[static_cast<int>(square)];
-    if (knightAttacks & knights) {
-        return true;
-    }
-    
-    // Check for king attacks
-    bitboard king = byColor == WHITE ? board.getPieceBB(static_cast<Piece>(KING)) : board.getPieceBB(static_cast<Piece>(KING + 6));
-    bitboard kingAttacks = KING_ATTACKS[static_cast<int>(square)];
-    if (kingAttacks & king) {
-        return true;
-    }
-    
-    // Check for bishop/queen attacks (diagonal)
-    bitboard bishopsQueens = (byColor == WHITE ? board.getPieceBB(static_cast<Piece>(BISHOP)) : board.getPieceBB(static_cast<Piece>(BISHOP + 6))) | 
-                            (byColor == WHITE ? board.getPieceBB(static_cast<Piece>(QUEEN)) : board.getPieceBB(static_cast<Piece>(QUEEN + 6)));
-    bitboard bishopAttacks = getBishopAttacks(square, board.allOccupancy());
-    if (bishopAttacks & bishopsQueens) {
-        return true;
-    }
-    
-    // Check for rook/queen attacks (orthogonal)
-    bitboard rooksQueens = (byColor == WHITE ? board.getPieceBB(static_cast<Piece>(ROOK)) : board.getPieceBB(static_cast<Piece>(ROOK + 6))) | 
-                          (byColor == WHITE ? board.getPieceBB(static_cast<Piece>(QUEEN)) : board.getPieceBB(static_cast<Piece>(QUEEN + 6)));
-    bitboard rookAttacks = getRookAttacks(square, board.allOccupancy());
-    if (rookAttacks & rooksQueens) {
-        return true;
-    }
-    
-    return false;
-}
+template<MoveGen::GenType Type, Color Us>
+void MoveGen::generateBishopMoves(const Board& board, MoveList& moves, const LegalMasks& masks) {
+    bitboard bishops = board.bishops(Us);
 
-bool MoveGen::isLegalMove(const Board& board, const Move& move) {
-    Color side = board.getSideToMove();
-    Color enemy = static_cast<Color>(1 - side);
+    while (bishops) {
+        Square from = static_cast<Square>(__builtin_ctzll(bishops));
+        bitboard attacks = getBishopAttacks(from, board.allOccupancy());
+        addMoves(board, moves, from, pieceTargets<Type>(masks, BISHOP, from, attacks), BISHOP);
+        bishops &= bishops - 1;
+    }
+}
 
-    // --- Basic sanity checks -------------------------------------------------
+template<MoveGen::GenType Type, Color Us>
+void MoveGen::generateRookMoves(const Board& board, MoveList& moves, const LegalMasks& masks) {
+    bitboard rooks = board.rooks(Us);
 
-    // Get the piece being moved from the board
-    Piece movingPiece = board.pieceAt(move.from());
-    if (movingPiece == NO_PIECE) {
-        return false; // no piece on source square
+    while (rooks) {
+        Square from = static_cast<Square>(__builtin_ctzll(rooks));
+        bitboard attacks = getRookAttacks(from, board.allOccupancy());
+        addMoves(board, moves, from, pieceTargets<Type>(masks, ROOK, from, attacks), ROOK);
+        rooks &= rooks - 1;
     }
+}
 
-    // Ensure the piece belongs to the side to move
-    if ((side == WHITE && movingPiece >= 6) ||
-        (side == BLACK && movingPiece < 6)) {
-        return false;
+template<MoveGen::GenType Type, Color Us>
+void MoveGen::generateQueenMoves(const Board& board, MoveList& moves, const LegalMasks& masks) {
+    bitboard queens = board.queens(Us);
+
+    while (queens) {
+        Square from = static_cast<Square>(__builtin_ctzll(queens));
+        bitboard attacks = getRookAttacks(from, board.allOccupancy()) | getBishopAttacks(from, board.allOccupancy());
+        addMoves(board, moves, from, pieceTargets<Type>(masks, QUEEN, from, attacks), QUEEN);
+        queens &= queens - 1;
     }
+}
 
-    // Verify the move's piece type matches the board
-    if (move.piece() != static_cast<Piece>(static_cast<int>(movingPiece) % 6)) {
-        return false;
+template<MoveGen::GenType Type>
+void MoveGen::generateKingMoves(const Board& board, MoveList& moves, const LegalMasks& masks) {
+    bitboard attacks = KING_ATTACKS[static_cast<int>(masks.kingSq)] & masks.target & ~masks.enemyAttacks;
+
+    // The king can only give a discovered check
+    if constexpr (Type == QUIET_CHECKS) {
+        if (!(masks.discoverers & (1ULL << static_cast<int>(masks.kingSq)))) return;
+        attacks &= ~LINE[static_cast<int>(masks.enemyKingSq)][static_cast<int>(masks.kingSq)];
     }
+    addMoves(board, moves, masks.kingSq, attacks, KING);
+}
 
-    // Destination square must not contain our own piece
-    Piece destPiece = board.pieceAt(move.to());
-    if (destPiece != NO_PIECE) {
-        if ((side == WHITE && destPiece < 6) || (side == BLACK && destPiece >= 6)) {
-            return false;
-        }
+// Bit KINGSIDE and/or QUEENSIDE set for each castle that is currently legal
+template<Color Us>
+int MoveGen::castlingSides(const Board& board, const LegalMasks& masks) {
+    // Castling out of check is never legal
+    if (masks.checkers) {
+        return 0;
     }
 
-    // --- Pseudo-legal check -------------------------------------------------
+    constexpr Piece RookPiece = static_cast<Piece>(ROOK + Us * 6);
 
-    // Generate pseudo-legal moves and ensure the move exists
-    std::vector<Move> pseudoMoves = generatePseudoLegalMoves(board);
-    bool found = false;
-    for (const Move& m : pseudoMoves) {
-        if (m == move) { found = true; break; }
-    }
-    if (!found) {
-        return false;
-    }
+    // Squares that must be empty, and the subset the king crosses that must not be attacked
+    constexpr bitboard KS_EMPTY = Us == WHITE ? (1ULL << 5) | (1ULL << 6) : (1ULL << 61) | (1ULL << 62);
+    constexpr bitboard QS_EMPTY = Us == WHITE ? (1ULL << 1) | (1ULL << 2) | (1ULL << 3) : (1ULL << 57) | (1ULL << 58) | (1ULL << 59);
+    constexpr bitboard QS_SAFE  = Us == WHITE ? (1ULL << 2) | (1ULL << 3) : (1ULL << 58) | (1ULL << 59);
 
-    // --- King safety check --------------------------------------------------
+    bitboard occAll = board.allOccupancy();
+    int sides = 0;
 
-    // Copy the board and play the move
-    Board testBoard = board;
-    testBoard.makeMove(move);
+    // Check kingside castling
+    if (board.hasCastlingRight(Us, KINGSIDE)
+        && board.pieceAt(Us == WHITE ? H1 : H8) == RookPiece
+        && !(occAll & KS_EMPTY)
+        && !(masks.enemyAttacks & KS_EMPTY)) {
+        sides |= 1 << KINGSIDE;
+    }
 
-    // Determine king square after the move
-    Piece kingPiece = static_cast<Piece>(KING + (side * 6));
-    bitboard kingBB = testBoard.getPieceBB(kingPiece);
-    Square kingSquare = static_cast<Square>(__builtin_ctzll(kingBB));
+    // Check queenside castling
+    if (board.hasCastlingRight(Us, QUEENSIDE)
+        && board.pieceAt(Us == WHITE ? A1 : A8) == RookPiece
+        && !(occAll & QS_EMPTY)
+        && !(masks.enemyAttacks & QS_SAFE)) {
+        sides |= 1 << QUEENSIDE;
+    }
 
-    return !isSquareAttacked(testBoard, kingSquare, enemy);
+    return sides;
 }
 
-bitboard MoveGen::allEnemyAttacks(const Board& board, Color side) {
-    Color enemy = static_cast<Color>(!side);
-    bitboard attacks = 0;
-    bitboard occAll = board.allOccupancy();
-    
-    // Pawn attacks
-    bitboard pawns = board.getPieceBB(static_cast<Piece>(PAWN + (enemy * 6)));
-    while (pawns) {
-        Square from = static_cast<Square>(__builtin_ctzll(pawns));
-        attacks |= PAWN_ATTACKS[enemy][static_cast<int>(from)];
-        pawns &= pawns - 1;
-    }
-    
-    // Knight attacks
-    bitboard knights = board.getPieceBB(static_cast<Piece>(KNIGHT + (enemy * 6)));
-    while (knights) {
-        Square from = static_cast<Square>(__builtin_ctzll(knights));
-        attacks |= KNIGHT_ATTACKS[static_cast<int>(from)];
-        knights &= knights - 1;
+template<Color Us>
+void MoveGen::generateCastlingMoves(const Board& board, MoveList& moves, const LegalMasks& masks) {
+    constexpr Square KingFrom = Us == WHITE ? E1 : E8;
+    int sides = castlingSides<Us>(board, masks);
+
+    if (sides & (1 << KINGSIDE)) {
+        moves.push(makeCastle(KingFrom, Us == WHITE ? G1 : G8));
     }
-    
-    // King attacks
-    bitboard king = board.getPieceBB(static_cast<Piece>(KING + (enemy * 6)));
-    if (king) {
-        Square from = static_cast<Square>(__builtin_ctzll(king));
-        attacks |= KING_ATTACKS[static_cast<int>(from)];
-    }
-    
-    // Bishop/Queen attacks
-    bitboard bishopsQueens = board.getPieceBB(static_cast<Piece>(BISHOP + (enemy * 6))) | 
-                            board.getPieceBB(static_cast<Piece>(QUEEN + (enemy * 6)));
-    while (bishopsQueens) {
-        Square from = static_cast<Square>(__builtin_ctzll(bishopsQueens));
-        attacks |= getBishopAttacks(from, occAll);
-        bishopsQueens &= bishopsQueens - 1;
-    }
-    
-    // Rook/Queen attacks
-    bitboard rooksQueens = board.getPieceBB(static_cast<Piece>(ROOK + (enemy * 6))) | 
-                          board.getPieceBB(static_cast<Piece>(QUEEN + (enemy * 6)));
-    while (rooksQueens) {
-        Square from = static_cast<Square>(__builtin_ctzll(rooksQueens));
-        attacks |= getRookAttacks(from, occAll);
-        rooksQueens &= rooksQueens - 1;
-    }
-    
-    return attacks;
-}
-
-// attack tables
-
-// Initialize lookup tables
-std::array<bitboard, 64> MoveGen::KNIGHT_ATTACKS;
-std::array<bitboard, 64> MoveGen::KING_ATTACKS;
-std::array<bitboard, 64> MoveGen::PAWN_ATTACKS[2];
-std::array<bitboard, 64> MoveGen::BISHOP_MASKS;
-std::array<bitboard, 64> MoveGen::ROOK_MASKS;
-std::array<uint64_t, 64> MoveGen::BISHOP_MAGICS;
-std::array<uint64_t, 64> MoveGen::ROOK_MAGICS;
-std::array<std::array<bitboard, 4096>, 64> MoveGen::BISHOP_ATTACKS;
-std::array<std::array<bitboard, 4096>, 64> MoveGen::ROOK_ATTACKS;
-bool MoveGen::initialized = false;
-
-// Magic numbers for rooks
-const uint64_t ROOK_MAGIC_NUMBERS[64] = {
-    0x0080001020400080ULL, 0x0040001000200040ULL, 0x0080081000200080ULL, 0x0080040800100080ULL,
-    0x0080020400080080ULL, 0x0080010200040080ULL, 0x0080008001000200ULL, 0x0080002040800100ULL,
-    0x0000800020400080ULL, 0x0000400020005000ULL, 0x0000801000200080ULL, 0x0000800800100080ULL,
-    0x0000800400080080ULL, 0x0000800200040080ULL, 0x0000800100020080ULL, 0x0000800040800100ULL,
-    0x0000208000400080ULL, 0x0000404000201000ULL, 0x0000808010002000ULL, 0x0000808008001000ULL,
-    0x0000808004000800ULL, 0x0000808002000400ULL, 0x0000010100020004ULL, 0x0000020000408104ULL,
-    0x0000208080004000ULL, 0x0000200040005000ULL, 0x0000100080200080ULL, 0x0000080080100080ULL,
-    0x0000040080080080ULL, 0x0000020080040080ULL, 0x0000010080800200ULL, 0x0000800080004100ULL,
-    0x0000204000800080ULL, 0x0000200040401000ULL, 0x0000100080802000ULL, 0x0000080080801000ULL,
-    0x0000040080800800ULL, 0x0000020080800400ULL, 0x0000020001010004ULL, 0x0000800040800100ULL,
-    0x0000204000808000ULL, 0x0000200040008080ULL, 0x0000100020008080ULL, 0x0000080010008080ULL,
-    0x0000040008008080ULL, 0x0000020004008080ULL, 0x0000800100020080ULL, 0x0000800041000080ULL,
-    0x00FFFCDDFCED714AULL, 0x007FFCDDFCED714AULL, 0x003FFFCDFFD88096ULL, 0x0000040810002101ULL,
-    0x0001000204080011ULL, 0x0001000204000801ULL, 0x0001000082000401ULL, 0x0001FFFAABFAD1A2ULL
-};
-
-// Magic numbers for bishops
-const uint64_t BISHOP_MAGIC_NUMBERS[64] = {
-    0x0002020202020200ULL, 0x0002020202020000ULL, 0x0004010202000000ULL, 0x0004040080000000ULL,
-    0x0001104000000000ULL, 0x0000821040000000ULL, 0x0000410410400000ULL, 0x0000104104104000ULL,
-    0x0000040404040400ULL, 0x0000020202020200ULL, 0x0000040102020000ULL, 0x0000040400800000ULL,
-    0x0000011040000000ULL, 0x0000008210400000ULL, 0x0000004104104000ULL, 0x0000002082082000ULL,
-    0x0004000808080800ULL, 0x0002000404040400ULL, 0x0001000202020200ULL, 0x0000800802004000ULL,
-    0x0000800400A00000ULL, 0x0000200100884000ULL, 0x0000400082082000ULL, 0x0000200041041000ULL,
-    0x0002080010101000ULL, 0x0001040008080800ULL, 0x0000208004010400ULL, 0x0000404004010200ULL,
-    0x0000840000802000ULL, 0x0000404002011000ULL, 0x0000808001041000ULL, 0x0000404000820800ULL,
-    0x0001041000202000ULL, 0x0000820800101000ULL, 0x0000104400080800ULL, 0x0000020080080080ULL,
-    0x0000404040040100ULL, 0x0000808100020100ULL, 0x0001010100020800ULL, 0x0000808080010400ULL,
-    0x0000820820004000ULL, 0x0000410410002000ULL, 0x0000082088001000ULL, 0x0000002011000800ULL,
-    0x0000080100400400ULL, 0x0001010101000200ULL, 0x0002020202000400ULL, 0x0001010101000200ULL,
-    0x0000410410400000ULL, 0x0000208208200000ULL, 0x0000002084100000ULL, 0x0000000020880000ULL,
-    0x0000001002020000ULL, 0x0000040408020000ULL, 0x0004040404040000ULL, 0x0002020202020000ULL,
-    0x0000104104104000ULL, 0x0000002082082000ULL, 0x0000000020841000ULL, 0x0000000000208800ULL,
-    0x0000000010020200ULL, 0x0000000404080200ULL, 0x0000040404040400ULL, 0x0002020202020200ULL
-};
-
-// Magic shifts for rooks
-const int ROOK_MAGIC_SHIFTS[64] = {
-    52, 53, 53, 53, 53, 53, 53, 52,
-    53, 54, 54, 54, 54, 54, 54, 53,
-    53, 54, 54, 54, 54, 54, 54, 53,
-    53, 54, 54, 54, 54, 54, 54, 53,
-    53, 54, 54, 54, 54, 54, 54, 53,
-    53, 54, 54, 54, 54, 54, 54, 53,
-    53, 54, 54, 54, 54, 54, 54, 53,
-    52, 53, 53, 53, 53, 53, 53, 52
-};
-
-// Magic shifts for bishops
-const int BISHOP_MAGIC_SHIFTS[64] = {
-    58, 59, 59, 59, 59, 59, 59, 58,
-    59, 59, 59, 59, 59, 59, 59, 59,
-    59, 59, 57, 57, 57, 57, 59, 59,
-    59, 59, 57, 55, 55, 57, 59, 59,
-    59, 59, 57, 55, 55, 57, 59, 59,
-    59, 59, 57, 57, 57, 57, 59, 59,
-    59, 59, 59, 59, 59, 59, 59, 59,
-    58, 59, 59, 59, 59, 59, 59, 58
-};
-
-// Initialize the attack tables
-void MoveGen::initializeAttackTables() {
-    if (initialized) return;
-    
-    // Initialize knight attacks
-    for (int square = 0; square < 64; square++) {
-        KNIGHT_ATTACKS[square] = generateKnightAttacks(static_cast<Square>(square));
-    }
-
-    // Initialize king attacks
-    for (int square = 0; square < 64; square++) {
-        KING_ATTACKS[square] = generateKingAttacks(static_cast<Square>(square));
-    }
-
-    // Initialize pawn attacks
-    for (int square = 0; square < 64; square++) {
-        PAWN_ATTACKS[WHITE][square] = generatePawnAttacks(static_cast<Square>(square), WHITE);
-        PAWN_ATTACKS[BLACK][square] = generatePawnAttacks(static_cast<Square>(square), BLACK);
-    }
-
-    // Initialize bishop and rook masks
-    for (int square = 0; square < 64; square++) {
-        BISHOP_MASKS[square] = generateBishopMask(static_cast<Square>(square));
-        ROOK_MASKS[square] = generateRookMask(static_cast<Square>(square));
-    }
-
-    // Copy magic numbers
-    std::copy(ROOK_MAGIC_NUMBERS, ROOK_MAGIC_NUMBERS + 64, ROOK_MAGICS.begin());
-    std::copy(BISHOP_MAGIC_NUMBERS, BISHOP_MAGIC_NUMBERS + 64, BISHOP_MAGICS.begin());
-
-    // Initialize magic bitboard attack tables
-    for (int square = 0; square < 64; square++) {
-        // Initialize bishop attacks
-        bitboard mask = BISHOP_MASKS[square];
-        int n = __builtin_popcountll(mask);
-        for (int i = 0; i < (1 << n); i++) {
-            bitboard occupancy = 0;
-            bitboard temp = mask;
-            for (int j = 0; j < n; j++) {
-                int lsb = __builtin_ctzll(temp);
-                if (i & (1 << j)) {
-                    occupancy |= (1ULL << lsb);
-                }
-                temp &= temp - 1;
-            }
-            int index = (occupancy * BISHOP_MAGICS[square]) >> BISHOP_MAGIC_SHIFTS[square];
-            BISHOP_ATTACKS[square][index] = calculateBishopAttacks(static_cast<Square>(square), occupancy);
-        }
+    if (sides & (1 << QUEENSIDE)) {
+        moves.push(makeCastle(KingFrom, Us == WHITE ? C1 : C8));
+    }
+}
 
-        // Initialize rook attacks
-        mask = ROOK_MASKS[square];
-        n = __builtin_popcountll(mask);
-        for (int i = 0; i < (1 << n); i++) {
-            bitboard occupancy = 0;
-            bitboard temp = mask;
-            for (int j = 0; j < n; j++) {
-                int lsb = __builtin_ctzll(temp);
-                if (i & (1 << j)) {
-                    occupancy |= (1ULL << lsb);
-                }
-                temp &= temp - 1;
-            }
-            int index = (occupancy * ROOK_MAGICS[square]) >> ROOK_MAGIC_SHIFTS[square];
-            ROOK_ATTACKS[square][index] = calculateRookAttacks(static_cast<Square>(square), occupancy);
+// Origins of our pawns that can legally capture en passant
+template<Color Us>
+bitboard MoveGen::enPassantCapturers(const Board& board, const LegalMasks& masks) {
+    int epFile = board.getEpFile();
+    if (epFile == -1) return 0;
+
+    constexpr Color Them = Us == WHITE ? BLACK : WHITE;
+    int epSquare = (Us == WHITE ? 5 : 2) * 8 + epFile;
+    bitboard capBB = 1ULL << (epSquare + (Us == WHITE ? -8 : 8));
+
+    if (!(board.pawns(Them) & capBB)) return 0;
+
+    // Our pawns that attack the en passant square
+    bitboard candidates = PAWN_ATTACKS[Them][epSquare] & board.pawns(Us);
+    bitboard legal = 0;
+    while (candidates) {
+        bitboard fromBB = candidates & -candidates;
+
+        // Two pawns leave their squares at once, which can expose the king
+        // along the rank as well as along a diagonal pin, so the king is
+        // tested against the occupancy after the capture.
+        bitboard occAfter = (board.allOccupancy() ^ fromBB ^ capBB) | (1ULL << epSquare);
+        bitboard attackers = attackersTo(board, masks.kingSq, occAfter) & board.occupancy(Them) & ~capBB;
+        if (!attackers) {
+            legal |= fromBB;
         }
+
+        candidates &= candidates - 1;
     }
-    
-    initialized = true;
+    return legal;
 }
 
-bitboard MoveGen::generateKnightAttacks(Square square) {
-    bitboard attacks = 0;
-    int rank = static_cast<int>(square) / 8;
-    int file = static_cast<int>(square) % 8;
+template<Color Us>
+void MoveGen::generateEnPassantMoves(const Board& board, MoveList& moves, const LegalMasks& masks) {
+    bitboard capturers = enPassantCapturers<Us>(board, masks);
+    Square epSquare = static_cast<Square>((Us == WHITE ? 5 : 2) * 8 + board.getEpFile());
 
-    // All possible knight moves
-    const int knightMoves[8][2] = {
-        {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2},
-        {1, -2}, {1, 2}, {2, -1}, {2, 1}
-    };
+    while (capturers) {
+        moves.push(makeEP(static_cast<Square>(__builtin_ctzll(capturers)), epSquare, PAWN));
+        capturers &= capturers - 1;
+    }
+}
+
+bitboard MoveGen::attackersTo(const Board& board, Square square, bitboard occupancy) {
+    int sq = static_cast<int>(square);
+    bitboard bishopsQueens = board.bishops(WHITE) | board.bishops(BLACK) | board.queens(WHITE) | board.queens(BLACK);
+    bitboard rooksQueens = board.rooks(WHITE) | board.rooks(BLACK) | board.queens(WHITE) | board.queens(BLACK);
+
+    return (PAWN_ATTACKS[BLACK][sq] & board.pawns(WHITE))
+         | (PAWN_ATTACKS[WHITE][sq] & board.pawns(BLACK))
+         | (KNIGHT_ATTACKS[sq] & (board.knights(WHITE) | board.knights(BLACK)))
+         | (KING_ATTACKS[sq] & (board.king(WHITE) | board.king(BLACK)))
+         | (getBishopAttacks(square, occupancy) & bishopsQueens)
+         | (getRookAttacks(square, occupancy) & rooksQueens);
+}
+
+bitboard MoveGen::pinnedPieces(const Board& board, Color side, Square kingSq) {
+    return sliderBlockers(board, kingSq, static_cast<Color>(!side)) & board.occupancy(side);
+}
 
-    for (const auto& move : knightMoves) {
-        int newRank = rank + move[0];
-        int newFile = file + move[1];
-        
-        if (newRank >= 0 && newRank < 8 && newFile >= 0 && newFile < 8) {
-            attacks |= 1ULL << (newRank * 8 + newFile);
+// Pieces of either color that are the only blocker between the king and a
+// slider of sniperSide
+bitboard MoveGen::sliderBlockers(const Board& board, Square kingSq, Color sniperSide) {
+    int ksq = static_cast<int>(kingSq);
+
+    // Sliders that would attack the king on an empty board
+    bitboard snipers = (getRookAttacks(kingSq, 0) & (board.rooks(sniperSide) | board.queens(sniperSide)))
+                     | (getBishopAttacks(kingSq, 0) & (board.bishops(sniperSide) | board.queens(sniperSide)));
+    bitboard result = 0;
+
+    while (snipers) {
+        int sniperSq = __builtin_ctzll(snipers);
+        bitboard blockers = BETWEEN[ksq][sniperSq] & board.allOccupancy();
+
+        // Exactly one blocker
+        if (blockers && !(blockers & (blockers - 1))) {
+            result |= blockers;
         }
+
+        snipers &= snipers - 1;
     }
 
-    return attacks;
+    return result;
+}
+
+// Cheapest piece classes first so most queries return before a slider lookup
+template<Color Them>
+bool MoveGen::attackedBy(const Board& board, Square square) {
+    constexpr Color Us = Them == WHITE ? BLACK : WHITE;
+    int sq = static_cast<int>(square);
+    bitboard occ = board.allOccupancy();
+
+    return (PAWN_ATTACKS[Us][sq] & board.pawns(Them))
+        || (KNIGHT_ATTACKS[sq] & board.knights(Them))
+        || (KING_ATTACKS[sq] & board.king(Them))
+        || (getBishopAttacks(square, occ) & (board.bishops(Them) | board.queens(Them)))
+        || (getRookAttacks(square, occ) & (board.rooks(Them) | board.queens(Them)));
+}
+
+bool MoveGen::isSquareAttacked(const Board& board, Square square, Color byColor) {
+    return byColor == WHITE ? attackedBy<WHITE>(board, square) : attackedBy<BLACK>(board, square);
+}
+
+bool MoveGen::inCheck(const Board& board) {
+    const AttackInfo& info = board.getSideToMove() == WHITE ? legalityInfo<WHITE>(board) : legalityInfo<BLACK>(board);
+    return info.checkers != 0;
+}
+
+bool MoveGen::isLegalMove(const Board& board, const Move& move) {
+    return board.getSideToMove() == WHITE ? isLegal<WHITE>(board, move) : isLegal<BLACK>(board, move);
 }
 
-bitboard MoveGen::generateKingAttacks(Square square) {
-    bitboard attacks = 0;
-    int rank = static_cast<int>(square) / 8;
-    int file = static_cast<int>(square) % 8;
+template<Color Us>
+bool MoveGen::isLegal(const Board& board, Move move) {
+    constexpr Color Them = Us == WHITE ? BLACK : WHITE;
+    constexpr int   Up   = Us == WHITE ? 8 : -8;
 
-    // All possible king moves
-    const int kingMoves[8][2] = {
-        {-1, -1}, {-1, 0}, {-1, 1},
-        {0, -1}, {0, 1},
-        {1, -1}, {1, 0}, {1, 1}
-    };
+    // Ordering score bits are not part of the move
+    move.setScore(0);
 
-    for (const auto& move : kingMoves) {
-        int newRank = rank + move[0];
-        int newFile = file + move[1];
-        
-        if (newRank >= 0 && newRank < 8 && newFile >= 0 && newFile < 8) {
-            attacks |= 1ULL << (newRank * 8 + newFile);
+    if (move.isCastle() || move.isEP()) {
+        MoveList moves;
+        if (move.isCastle()) {
+            generate<QUIETS, Us>(board, moves);
+        } else {
+            generate<CAPTURES, Us>(board, moves);
         }
+        return moves.contains(move);
     }
 
-    return attacks;
-}
+    int from = static_cast<int>(move.from());
+    int to = static_cast<int>(move.to());
+    Piece pt = move.piece();
+    if (from == to || pt > KING || board.pieceAt(move.from()) != static_cast<Piece>(pt + 6 * Us)) {
+        return false;
+    }
 
-bitboard MoveGen::generatePawnAttacks(Square square, Color color) {
-    bitboard attacks = 0;
-    int rank = static_cast<int>(square) / 8;
-    int file = static_cast<int>(square) % 8;
+    // The encoded capture has to match what stands on the target
+    Piece target = board.pieceAt(move.to());
+    if (target == NO_PIECE) {
+        if (move.isCapture()) {
+            return false;
+        }
+    } else if (!move.isCapture() || move.captured() > QUEEN || target != static_cast<Piece>(move.captured() + 6 * Them)) {
+        return false;
+    }
 
-    if (color == WHITE) {
-        if (rank < 7) {
-            if (file > 0) attacks |= 1ULL << ((rank + 1) * 8 + (file - 1));
-            if (file < 7) attacks |= 1ULL << ((rank + 1) * 8 + (file + 1));
+    bitboard toBB = 1ULL << to;
+    bitboard occupancy = board.allOccupancy();
+    if (pt == PAWN) {
+        bool lastRank = to / 8 == (Us == WHITE ? 7 : 0);
+        bool doublePush = !move.isCapture() && to == from + 2 * Up
+                       && from / 8 == (Us == WHITE ? 1 : 6) && !(occupancy & (1ULL << (from + Up)));
+        bool reaches = move.isCapture() ? (PAWN_ATTACKS[Us][from] & toBB) != 0 : to == from + Up || doublePush;
+        if (!reaches || lastRank != move.isPromotion() || move.promotion() > QUEEN
+            || move.isDoublePush() != doublePush) {
+            return false;
         }
     } else {
-        if (rank > 0) {
-            if (file > 0) attacks |= 1ULL << ((rank - 1) * 8 + (file - 1));
-            if (file < 7) attacks |= 1ULL << ((rank - 1) * 8 + (file + 1));
+        if (move.isPromotion() || move.flags() != Move::QUIET) {
+            return false;
+        }
+        bitboard attacks = pt == KNIGHT ? KNIGHT_ATTACKS[from]
+                         : pt == BISHOP ? getBishopAttacks(move.from(), occupancy)
+                         : pt == ROOK   ? getRookAttacks(move.from(), occupancy)
+                         : pt == QUEEN  ? getBishopAttacks(move.from(), occupancy) | getRookAttacks(move.from(), occupancy)
+                         :                KING_ATTACKS[from];
+        if (!(attacks & toBB)) {
+            return false;
         }
     }
 
-    return attacks;
-}
-
-bitboard MoveGen::generateBishopMask(Square square) {
-    bitboard mask = 0;
-    int rank = static_cast<int>(square) / 8;
-    int file = static_cast<int>(square) % 8;
-
-    // Generate mask for all possible bishop moves
-    for (int r = rank + 1, f = file + 1; r < 7 && f < 7; r++, f++) mask |= 1ULL << (r * 8 + f);
-    for (int r = rank + 1, f = file - 1; r < 7 && f > 0; r++, f--) mask |= 1ULL << (r * 8 + f);
-    for (int r = rank - 1, f = file + 1; r > 0 && f < 7; r--, f++) mask |= 1ULL << (r * 8 + f);
-    for (int r = rank - 1, f = file - 1; r > 0 && f > 0; r--, f--) mask |= 1ULL << (r * 8 + f);
+    // Same rules as legalMasks: the king avoids attacked squares, anything
+    // else answers a single check and stays on its pin line
+    const AttackInfo& info = legalityInfo<Us>(board);
+    if (pt == KING) {
+        return !(info.kingDanger & toBB);
+    }
 
-    return mask;
+    int kingSq = __builtin_ctzll(board.king(Us));
+    if (info.checkers) {
+        if (info.checkers & (info.checkers - 1)) {
+            return false;
+        }
+        bitboard checkMask = BETWEEN[kingSq][__builtin_ctzll(info.checkers)] | info.checkers;
+        if (!(checkMask & toBB)) {
+            return false;
+        }
+    }
+    return !(info.pinned[Us] & (1ULL << from)) || (LINE[kingSq][from] & toBB);
 }
 
-bitboard MoveGen::generateRookMask(Square square) {
-    bitboard mask = 0;
-    int rank = static_cast<int>(square) / 8;
-    int file = static_cast<int>(square) % 8;
+// Pawn, knight and king attacks of one side; they do not depend on occupancy
+template<Color C>
+void MoveGen::leaperAttacks(const Board& board, bitboard out[6]) {
+    bitboard pawns = board.pawns(C);
+    out[PAWN] = C == WHITE ? shift<7>(pawns) | shift<9>(pawns) : shift<-9>(pawns) | shift<-7>(pawns);
 
-    // Generate mask for all possible rook moves
-    for (int r = rank + 1; r < 7; r++) mask |= 1ULL << (r * 8 + file);
-    for (int r = rank - 1; r > 0; r--) mask |= 1ULL << (r * 8 + file);
-    for (int f = file + 1; f < 7; f++) mask |= 1ULL << (rank * 8 + f);
-    for (int f = file - 1; f > 0; f--) mask |= 1ULL << (rank * 8 + f);
+    out[KNIGHT] = 0;
+    bitboard knights = board.knights(C);
+    while (knights) {
+        out[KNIGHT] |= KNIGHT_ATTACKS[__builtin_ctzll(knights)];
+        knights &= knights - 1;
+    }
 
-    return mask;
+    out[KING] = KING_ATTACKS[__builtin_ctzll(board.king(C))];
 }
 
-bitboard MoveGen::calculateBishopAttacks(Square square, bitboard occupancy) {
-    bitboard attacks = 0;
-    int rank = static_cast<int>(square) / 8;
-    int file = static_cast<int>(square) % 8;
+template<Color C>
+void MoveGen::sliderAttacks(const Board& board, bitboard occupancy, bitboard out[6]) {
+    out[BISHOP] = out[ROOK] = out[QUEEN] = 0;
 
-    // Generate attacks in all four directions
-    for (int r = rank + 1, f = file + 1; r < 8 && f < 8; r++, f++) {
-        attacks |= 1ULL << (r * 8 + f);
-        if (occupancy & (1ULL << (r * 8 + f))) break;
+    bitboard bishops = board.bishops(C);
+    while (bishops) {
+        out[BISHOP] |= getBishopAttacks(static_cast<Square>(__builtin_ctzll(bishops)), occupancy);
+        bishops &= bishops - 1;
     }
-    for (int r = rank + 1, f = file - 1; r < 8 && f >= 0; r++, f--) {
-        attacks |= 1ULL << (r * 8 + f);
-        if (occupancy & (1ULL << (r * 8 + f))) break;
+
+    bitboard rooks = board.rooks(C);
+    while (rooks) {
+        out[ROOK] |= getRookAttacks(static_cast<Square>(__builtin_ctzll(rooks)), occupancy);
+        rooks &= rooks - 1;
     }
-    for (int r = rank - 1, f = file + 1; r >= 0 && f < 8; r--, f++) {
-        attacks |= 1ULL << (r * 8 + f);
-        if (occupancy & (1ULL << (r * 8 + f))) break;
+
+    bitboard queens = board.queens(C);
+    while (queens) {
+        Square from = static_cast<Square>(__builtin_ctzll(queens));
+        out[QUEEN] |= getBishopAttacks(from, occupancy) | getRookAttacks(from, occupancy);
+        queens &= queens - 1;
     }
-    for (int r = rank - 1, f = file - 1; r >= 0 && f >= 0; r--, f--) {
-        attacks |= 1ULL << (r * 8 + f);
-        if (occupancy & (1ULL << (r * 8 + f))) break;
+}
+
+// Checkers, our pins and the squares our king may not step to. This is all
+// generation needs, so the full attack maps are left for attackInfo.
+template<Color Us>
+const AttackInfo& MoveGen::legalityInfo(const Board& board) {
+    AttackInfo& info = board.attackInfo;
+    if (board.attackInfoLevel != Board::ATTACKS_NONE) {
+        return info;
     }
 
-    return attacks;
-}
+    constexpr Color Them = Us == WHITE ? BLACK : WHITE;
+    bitboard king = board.king(Us);
+    Square kingSq = static_cast<Square>(__builtin_ctzll(king));
 
-bitboard MoveGen::calculateRookAttacks(Square square, bitboard occupancy) {
-    bitboard attacks = 0;
-    int rank = static_cast<int>(square) / 8;
-    int file = static_cast<int>(square) % 8;
+    info.checkers = attackersTo(board, kingSq, board.allOccupancy()) & board.occupancy(Them);
+    info.pinned[Us] = pinnedPieces(board, Us, kingSq);
 
-    // Generate attacks in all four directions
-    for (int r = rank + 1; r < 8; r++) {
-        attacks |= 1ULL << (r * 8 + file);
-        if (occupancy & (1ULL << (r * 8 + file))) break;
-    }
-    for (int r = rank - 1; r >= 0; r--) {
-        attacks |= 1ULL << (r * 8 + file);
-        if (occupancy & (1ULL << (r * 8 + file))) break;
-    }
-    for (int f = file + 1; f < 8; f++) {
-        attacks |= 1ULL << (rank * 8 + f);
-        if (occupancy & (1ULL << (rank * 8 + f))) break;
+    // Leaper sets are final; sliders are x-rayed through our king so it
+    // cannot step back along a checking ray. Only the union matters here,
+    // so the sliders are filled setwise instead of looked up one by one.
+    leaperAttacks<Them>(board, info.pieceAttacks[Them]);
+    bitboard danger = info.pieceAttacks[Them][PAWN] | info.pieceAttacks[Them][KNIGHT] | info.pieceAttacks[Them][KING];
+    bitboard occupancy = board.allOccupancy() ^ king;
+
+    danger |= Fill::bishopAttacks(board.bishops(Them) | board.queens(Them), ~occupancy)
+            | Fill::rookAttacks(board.rooks(Them) | board.queens(Them), ~occupancy);
+    info.kingDanger = danger;
+
+    board.attackInfoLevel = Board::ATTACKS_LEGALITY;
+    return info;
+}
+
+template<Color Us>
+const AttackInfo& MoveGen::fullAttackInfo(const Board& board) {
+    AttackInfo& info = board.attackInfo;
+    legalityInfo<Us>(board);
+    if (board.attackInfoLevel == Board::ATTACKS_FULL) {
+        return info;
     }
-    for (int f = file - 1; f >= 0; f--) {
-        attacks |= 1ULL << (rank * 8 + f);
-        if (occupancy & (1ULL << (rank * 8 + f))) break;
+
+    constexpr Color Them = Us == WHITE ? BLACK : WHITE;
+    info.pinned[Them] = pinnedPieces(board, Them, static_cast<Square>(__builtin_ctzll(board.king(Them))));
+
+    leaperAttacks<Us>(board, info.pieceAttacks[Us]);
+    sliderAttacks<Us>(board, board.allOccupancy(), info.pieceAttacks[Us]);
+    sliderAttacks<Them>(board, board.allOccupancy(), info.pieceAttacks[Them]);
+
+    for (Color c : {WHITE, BLACK}) {
+        info.attacked[c] = 0;
+        for (int pt = PAWN; pt <= KING; ++pt) {
+            info.attacked[c] |= info.pieceAttacks[c][pt];
+        }
     }
 
-    return attacks;
+    board.attackInfoLevel = Board::ATTACKS_FULL;
+    return info;
 }
 
-bitboard MoveGen::getBishopAttacks(Square square, bitboard occupancy) {
-    occupancy &= BISHOP_MASKS[static_cast<int>(square)];
-    occupancy *= BISHOP_MAGICS[static_cast<int>(square)];
-    occupancy >>= BISHOP_MAGIC_SHIFTS[static_cast<int>(square)];
-    return BISHOP_ATTACKS[static_cast<int>(square)][occupancy];
+const AttackInfo& MoveGen::attackInfo(const Board& board) {
+    return board.getSideToMove() == WHITE ? fullAttackInfo<WHITE>(board) : fullAttackInfo<BLACK>(board);
 }
-
-bitboard MoveGen::getRookAttacks(Square square, bitboard occupancy) {
-    occupancy &= ROOK_MASKS[static_cast<int>(square)];
-    occupancy *= ROOK_MAGICS[static_cast<int>(square)];
-    occupancy >>= ROOK_MAGIC_SHIFTS[static_cast<int>(square)];
-    return ROOK_ATTACKS[static_cast<int>(square)][occupancy];
-} 
-
@@ -1,9 +1,19 @@
 #pragma once
 #include "../move/move.hpp"
+#include "../move/movelist.hpp"
 #include "../board/board.hpp"
-#include <vector>
 #include <array>
 
+// Slider lookups index the shared attack table with BMI2 PEXT instead of
+// magic multiplication when built with -DENABLE_PEXT=ON on a BMI2 host.
+#ifndef USE_PEXT
+#define USE_PEXT 0
+#endif
+
+#if USE_PEXT
+#include <immintrin.h>
+#endif
+
 constexpr Square A1 = Square(0), B1 = Square(1), C1 = Square(2), D1 = Square(3), E1 = Square(4), F1 = Square(5), G1 = Square(6), H1 = Square(7);
 constexpr Square A8 = Square(56), B8 = Square(57), C8 = Square(58), D8 = Square(59), E8 = Square(60), F8 = Square(61), G8 = Square(62), H8 = Square(63);
 
@@ -12,50 +22,164 @@ constexpr int QUEENSIDE = 1;
 
 class MoveGen {
 public:
-    static std::vector<Move> generatePseudoLegalMoves(const Board& board);
+    // Generates only legal moves. Checkers, pinned pieces and the check
+    // evasion mask are computed once per call, so no move is ever played
+    // to test it.
+    static void generateLegalMoves(const Board& board, MoveList& moves);
 
-    static void initializeAttackTables();
+    // Legal subsets for staged move ordering and quiescence. Captures and
+    // quiets partition the legal moves: captures include en passant and
+    // every promotion, quiets include castling.
+    static void generateCaptures(const Board& board, MoveList& moves);
+    static void generateQuiets(const Board& board, MoveList& moves);
 
-    static bool isLegalMove(const Board& board, const Move& move);
+    // All legal moves while in check
+    static void generateEvasions(const Board& board, MoveList& moves);
 
-private:
-    static void generatePawnMoves(const Board& board, std::vector<Move>& moves);
-    static void generateKnightMoves(const Board& board, std::vector<Move>& moves);
-    static void generateBishopMoves(const Board& board, std::vector<Move>& moves);
-    static void generateRookMoves(const Board& board, std::vector<Move>& moves);
-    static void generateQueenMoves(const Board& board, std::vector<Move>& moves);
-    static void generateKingMoves(const Board& board, std::vector<Move>& moves);
+    // Non-capture, non-promotion moves that give direct or discovered
+    // check, excluding castling. Meant for positions not in check.
+    static void generateQuietChecks(const Board& board, MoveList& moves);
 
-    static void generateCastlingMoves(const Board& board, std::vector<Move>& moves);
-    static void generateEnPassantMoves(const Board& board, std::vector<Move>& moves);
+    // Number of legal moves, counted from the target masks without building any Move
+    static int countLegalMoves(const Board& board);
+
+    // Legal move counts for the side to move indexed by piece type (castles
+    // count for the king, promotions four times). Returns the total.
+    static int countMobility(const Board& board, std::array<int, 6>& perPiece);
+
+    // Whether `move` is one of the legal moves here, exactly as the
+    // generators would encode it. Checked from the move's squares without
+    // generating anything, so table moves and killers can be validated
+    // cheaply; castling and en passant fall back to their generators.
+    static bool isLegalMove(const Board& board, const Move& move);
 
     static bool isSquareAttacked(const Board& board, Square square, Color byColor);
-    static bitboard allEnemyAttacks(const Board& board, Color side);
-
-    static std::array<bitboard, 64> KNIGHT_ATTACKS;
-    static std::array<bitboard, 64> KING_ATTACKS;
-    static std::array<bitboard, 64> PAWN_ATTACKS[2]; // [color][square]
-    
-    static std::array<bitboard, 64> BISHOP_MASKS;
-    static std::array<bitboard, 64> ROOK_MASKS;
-    
-    static std::array<uint64_t, 64> BISHOP_MAGICS;
-    static std::array<uint64_t, 64> ROOK_MAGICS;
-
-    static std::array<std::array<bitboard, 4096>, 64> BISHOP_ATTACKS;
-    static std::array<std::array<bitboard, 4096>, 64> ROOK_ATTACKS;
-    
-    static bool initialized;
-    
-    static bitboard generateKnightAttacks(Square square);
-    static bitboard generateKingAttacks(Square square);
-    static bitboard generatePawnAttacks(Square square, Color color);
-    static bitboard generateBishopMask(Square square);
-    static bitboard generateRookMask(Square square);
-    
-    static uint64_t findMagicNumber(Square square, bool isBishop);
+
+    // Static exchange evaluation: true if the capture sequence `move`
+    // starts on its destination gains at least `threshold` centipawns with
+    // both sides recapturing least valuable piece first. Castling, en
+    // passant and promotions are scored as an even exchange.
+    static bool see(const Board& board, Move move, int threshold);
+    static bool inCheck(const Board& board);
+
+    // Checkers, pins and attack maps for both sides. Computed once per
+    // position and cached on the board until the next make/unmake.
+    static const AttackInfo& attackInfo(const Board& board);
+
+    // Defined below so callers in every translation unit can inline them
     static bitboard getBishopAttacks(Square square, bitboard occupancy);
     static bitboard getRookAttacks(Square square, bitboard occupancy);
-    static bitboard calculateBishopAttacks(Square square, bitboard occupancy);
-    static bitboard calculateRookAttacks(Square square, bitboard occupancy);
-}; 
\ No newline at end of file
+
+    // 5248 bishop + 102400 rook entries (~841 KiB)
+    static constexpr int SLIDER_TABLE_SIZE = 107648;
+
+private:
+    enum GenType { CAPTURES, QUIETS, EVASIONS, QUIET_CHECKS, LEGAL };
+
+    // Legality data shared by all piece generators for one position
+    struct LegalMasks {
+        Square   kingSq;
+        bitboard checkers;
+        bitboard pinned;
+        bitboard checkMask;    // squares a non-king move must land on, empty in double check
+        bitboard enemyAttacks; // computed with our king removed
+        bitboard target;       // destinations allowed by the move category
+
+        // QUIET_CHECKS only
+        Square   enemyKingSq;
+        bitboard discoverers;     // our pieces shielding the enemy king from our sliders
+        bitboard checkSquares[6]; // [piece type] squares that attack the enemy king
+    };
+
+    template<Color Us> static LegalMasks legalMasks(const Board& board);
+    template<Color Us> static int countMoves(const Board& board, std::array<int, 6>& perPiece);
+    template<Color Us> static bool isLegal(const Board& board, Move move);
+
+    // Specialized per side to move; the public entry points dispatch once
+    template<GenType Type, Color Us> static void generate(const Board& board, MoveList& moves);
+
+    template<GenType Type, Color Us> static void generatePawnMoves(const Board& board, MoveList& moves, const LegalMasks& masks);
+    template<GenType Type, Color Us> static void generateKnightMoves(const Board& board, MoveList& moves, const LegalMasks& masks);
+    template<GenType Type, Color Us> static void generateBishopMoves(const Board& board, MoveList& moves, const LegalMasks& masks);
+    template<GenType Type, Color Us> static void generateRookMoves(const Board& board, MoveList& moves, const LegalMasks& masks);
+    template<GenType Type, Color Us> static void generateQueenMoves(const Board& board, MoveList& moves, const LegalMasks& masks);
+    template<GenType Type>           static void generateKingMoves(const Board& board, MoveList& moves, const LegalMasks& masks);
+
+    template<Color Us> static void generateCastlingMoves(const Board& board, MoveList& moves, const LegalMasks& masks);
+    template<Color Us> static void generateEnPassantMoves(const Board& board, MoveList& moves, const LegalMasks& masks);
+    template<Color Us> static int castlingSides(const Board& board, const LegalMasks& masks);
+    template<Color Us> static bitboard enPassantCapturers(const Board& board, const LegalMasks& masks);
+
+    // Narrows a piece's attack set to the legal destinations for the category
+    template<GenType Type> static bitboard pieceTargets(const LegalMasks& masks, Piece pt, Square from, bitboard attacks);
+
+    static void addMoves(const Board& board, MoveList& moves, Square from, bitboard targets, Piece pt);
+    template<int Delta> static void addPawnMoves(const Board& board, MoveList& moves, bitboard targets, int flags);
+    template<int Delta> static void addPromotions(const Board& board, MoveList& moves, bitboard targets);
+
+    // Moves every bit D squares (+8 is one rank up), dropping bits that would wrap around a file edge
+    template<int D>
+    static constexpr bitboard shift(bitboard b) {
+        if constexpr (D == 8)        return b << 8;
+        else if constexpr (D == 16)  return b << 16;
+        else if constexpr (D == -8)  return b >> 8;
+        else if constexpr (D == -16) return b >> 16;
+        else if constexpr (D == 9)   return (b & ~Board::FileBB[7]) << 9;
+        else if constexpr (D == 7)   return (b & ~Board::FileBB[0]) << 7;
+        else if constexpr (D == -7)  return (b & ~Board::FileBB[7]) >> 7;
+        else if constexpr (D == -9)  return (b & ~Board::FileBB[0]) >> 9;
+        else static_assert(D == 8, "unsupported shift");
+    }
+
+    static bitboard attackersTo(const Board& board, Square square, bitboard occupancy);
+    static bitboard pinnedPieces(const Board& board, Color side, Square kingSq);
+    static bitboard sliderBlockers(const Board& board, Square kingSq, Color sniperSide);
+    template<Color Us> static const AttackInfo& legalityInfo(const Board& board);
+    template<Color Us> static const AttackInfo& fullAttackInfo(const Board& board);
+    template<Color C>  static void leaperAttacks(const Board& board, bitboard out[6]);
+    template<Color C>  static void sliderAttacks(const Board& board, bitboard occupancy, bitboard out[6]);
+    template<Color Them> static bool attackedBy(const Board& board, Square square);
+
+    // Constant-initialized in attack_tables.cpp
+    static const std::array<bitboard, 64> KNIGHT_ATTACKS;
+    static const std::array<bitboard, 64> KING_ATTACKS;
+    static const std::array<bitboard, 64> PAWN_ATTACKS[2]; // [color][square]
+
+    static const std::array<std::array<bitboard, 64>, 64> BETWEEN; // squares strictly between two aligned squares
+    static const std::array<std::array<bitboard, 64>, 64> LINE;    // full board line through two aligned squares
+
+    static const std::array<bitboard, 64> BISHOP_MASKS;
+    static const std::array<bitboard, 64> ROOK_MASKS;
+
+    // Per-square slices of the shared slider table
+    static const std::array<uint32_t, 64> BISHOP_OFFSETS;
+    static const std::array<uint32_t, 64> ROOK_OFFSETS;
+    static const std::array<bitboard, SLIDER_TABLE_SIZE> SLIDER_ATTACKS;
+
+#if !USE_PEXT
+    static const std::array<uint64_t, 64> BISHOP_MAGICS;
+    static const std::array<uint64_t, 64> ROOK_MAGICS;
+    static const std::array<int, 64> BISHOP_SHIFTS;
+    static const std::array<int, 64> ROOK_SHIFTS;
+#endif
+};
+
+inline bitboard MoveGen::getBishopAttacks(Square square, bitboard occupancy) {
+    int sq = static_cast<int>(square);
+#if USE_PEXT
+    uint32_t index = static_cast<uint32_t>(_pext_u64(occupancy, BISHOP_MASKS[sq]));
+#else
+    uint32_t index = static_cast<uint32_t>(((occupancy & BISHOP_MASKS[sq]) * BISHOP_MAGICS[sq]) >> BISHOP_SHIFTS[sq]);
+#endif
+    return SLIDER_ATTACKS[BISHOP_OFFSETS[sq] + index];
+}
+
+inline bitboard MoveGen::getRookAttacks(Square square, bitboard occupancy) {
+    int sq = static_cast<int>(square);
+#if USE_PEXT
+    uint32_t index = static_cast<uint32_t>(_pext_u64(occupancy, ROOK_MASKS[sq]));
+#else
+    uint32_t index = static_cast<uint32_t>(((occupancy & ROOK_MASKS[sq]) * ROOK_MAGICS[sq]) >> ROOK_SHIFTS[sq]);
+#endif
+    return SLIDER_ATTACKS[ROOK_OFFSETS[sq] + index];
+}
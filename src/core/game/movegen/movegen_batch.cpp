@@ -0,0 +1,234 @@
+#include "movegen_batch.hpp"
+#include "fill.hpp"
+#include "movegen.hpp"
+
+// The kernel is compiled twice, for AVX2 and for the baseline target. Every
+// helper is force-inlined into both, so no 256-bit value ever crosses a
+// call boundary and the ABI note about vector arguments does not apply.
+#pragma GCC diagnostic ignored "-Wpsabi"
+#define BATCH_INLINE inline __attribute__((always_inline))
+
+namespace {
+
+// Four lanes of bitboards; GCC/Clang lower the operators to AVX2 or SSE2
+typedef bitboard Vec __attribute__((vector_size(32)));
+
+constexpr bitboard NOT_A  = Fill::NOT_A_FILE;
+constexpr bitboard NOT_H  = Fill::NOT_H_FILE;
+constexpr bitboard NOT_AB = NOT_A & (NOT_A << 1);
+constexpr bitboard NOT_GH = NOT_H & (NOT_H >> 1);
+constexpr bitboard RANK_3 = 0x0000000000FF0000ULL;
+constexpr bitboard RANK_8 = 0xFF00000000000000ULL;
+
+template<int S>
+BATCH_INLINE Vec shift(Vec b) {
+    if constexpr (S > 0) return b << S;
+    else return b >> -S;
+}
+
+// Kogge-Stone occluded fill, one direction, all lanes
+template<int S, bitboard Wrap>
+BATCH_INLINE Vec ray(Vec gen, Vec empty) {
+    Vec pro = empty & Wrap;
+    gen |= pro & shift<S>(gen);
+    pro &= shift<S>(pro);
+    gen |= pro & shift<2 * S>(gen);
+    pro &= shift<2 * S>(pro);
+    gen |= pro & shift<4 * S>(gen);
+    return shift<S>(gen) & Wrap;
+}
+
+BATCH_INLINE Vec load(const bitboard* lanes) {
+    Vec v;
+    __builtin_memcpy(&v, lanes, sizeof(v));
+    return v;
+}
+
+// Per-lane popcounts added into counts
+BATCH_INLINE void addCounts(int counts[4], Vec v, int weight = 1) {
+    for (int i = 0; i < 4; ++i) counts[i] += weight * __builtin_popcountll(v[i]);
+}
+
+BATCH_INLINE Vec knightAttacks(Vec n) {
+    return (shift<17>(n & NOT_H)) | (shift<15>(n & NOT_A)) | (shift<10>(n & NOT_GH)) | (shift<6>(n & NOT_AB))
+         | (shift<-6>(n & NOT_GH)) | (shift<-10>(n & NOT_AB)) | (shift<-15>(n & NOT_H)) | (shift<-17>(n & NOT_A));
+}
+
+BATCH_INLINE Vec kingAttacks(Vec k) {
+    Vec sides = shift<1>(k & NOT_H) | shift<-1>(k & NOT_A);
+    Vec row = k | sides;
+    return sides | shift<8>(row) | shift<-8>(row);
+}
+
+// Moves of `sliders` in one direction; rays stop at the first blocker, so
+// two of our sliders on one line never share a square and the popcount of
+// the direction is exactly its move count
+template<int S, bitboard Wrap>
+BATCH_INLINE Vec slide(Vec sliders, Vec empty, Vec notOurs, int counts[4], Vec& attacks) {
+    Vec r = ray<S, Wrap>(sliders, empty);
+    attacks |= r;
+    addCounts(counts, r & notOurs);
+    return r;
+}
+
+// Lanes where some piece of ours sits alone between our king and an enemy
+// slider along direction S
+template<int S, bitboard Wrap>
+BATCH_INLINE Vec pinnedAlong(Vec king, Vec empty, Vec ours, Vec snipers) {
+    Vec blocker = ray<S, Wrap>(king, empty) & ours;
+    return (Vec)((ray<S, Wrap>(blocker, empty) & snipers) != 0);
+}
+
+BATCH_INLINE void kernel(const PositionBatch& batch, BatchResult& result, bool scalar[4]) {
+    Vec us[6], them[6];
+    for (int pt = PAWN; pt <= KING; ++pt) {
+        us[pt] = load(batch.us[pt]);
+        them[pt] = load(batch.them[pt]);
+    }
+
+    Vec ours = us[PAWN] | us[KNIGHT] | us[BISHOP] | us[ROOK] | us[QUEEN] | us[KING];
+    Vec theirs = them[PAWN] | them[KNIGHT] | them[BISHOP] | them[ROOK] | them[QUEEN] | them[KING];
+    Vec empty = ~(ours | theirs);
+    Vec notOurs = ~ours;
+    Vec king = us[KING];
+
+    // Squares our king may not step to: enemy attacks with our king removed
+    Vec xray = empty | king;
+    Vec theirDiag = them[BISHOP] | them[QUEEN];
+    Vec theirOrth = them[ROOK] | them[QUEEN];
+    Vec danger = shift<-7>(them[PAWN] & NOT_H) | shift<-9>(them[PAWN] & NOT_A)
+               | knightAttacks(them[KNIGHT]) | kingAttacks(them[KING])
+               | ray<8, ~0ULL>(theirOrth, xray) | ray<-8, ~0ULL>(theirOrth, xray)
+               | ray<1, NOT_A>(theirOrth, xray) | ray<-1, NOT_H>(theirOrth, xray)
+               | ray<9, NOT_A>(theirDiag, xray) | ray<7, NOT_H>(theirDiag, xray)
+               | ray<-7, NOT_A>(theirDiag, xray) | ray<-9, NOT_H>(theirDiag, xray);
+
+    // Check or pins need the scalar legality rules
+    Vec hard = (Vec)((danger & king) != 0)
+             | pinnedAlong<8, ~0ULL>(king, empty, ours, theirOrth) | pinnedAlong<-8, ~0ULL>(king, empty, ours, theirOrth)
+             | pinnedAlong<1, NOT_A>(king, empty, ours, theirOrth) | pinnedAlong<-1, NOT_H>(king, empty, ours, theirOrth)
+             | pinnedAlong<9, NOT_A>(king, empty, ours, theirDiag) | pinnedAlong<7, NOT_H>(king, empty, ours, theirDiag)
+             | pinnedAlong<-7, NOT_A>(king, empty, ours, theirDiag) | pinnedAlong<-9, NOT_H>(king, empty, ours, theirDiag);
+
+    int counts[4] = {0, 0, 0, 0};
+
+    // Pawns: each destination set has one origin per square, promotions count four times
+    Vec single = shift<8>(us[PAWN]) & empty;
+    Vec dbl = shift<8>(single & RANK_3) & empty;
+    Vec capLeft = shift<7>(us[PAWN] & NOT_A) & theirs;
+    Vec capRight = shift<9>(us[PAWN] & NOT_H) & theirs;
+    addCounts(counts, single & ~RANK_8);
+    addCounts(counts, single & RANK_8, 4);
+    addCounts(counts, dbl);
+    addCounts(counts, capLeft & ~RANK_8);
+    addCounts(counts, capLeft & RANK_8, 4);
+    addCounts(counts, capRight & ~RANK_8);
+    addCounts(counts, capRight & RANK_8, 4);
+    Vec pawnTargets = single | dbl | capLeft | capRight;
+
+    // Knights: one move per (knight, jump direction) pair
+    Vec n = us[KNIGHT];
+    Vec knightTargets = Vec{};
+    Vec jumps[8] = {shift<17>(n & NOT_H), shift<15>(n & NOT_A), shift<10>(n & NOT_GH), shift<6>(n & NOT_AB),
+                    shift<-6>(n & NOT_GH), shift<-10>(n & NOT_AB), shift<-15>(n & NOT_H), shift<-17>(n & NOT_A)};
+    for (Vec j : jumps) {
+        addCounts(counts, j & notOurs);
+        knightTargets |= j;
+    }
+
+    // Sliders, direction by direction
+    Vec orth = us[ROOK] | us[QUEEN];
+    Vec diag = us[BISHOP] | us[QUEEN];
+    Vec sliderAttacks = Vec{};
+    slide<8, ~0ULL>(orth, empty, notOurs, counts, sliderAttacks);
+    slide<-8, ~0ULL>(orth, empty, notOurs, counts, sliderAttacks);
+    slide<1, NOT_A>(orth, empty, notOurs, counts, sliderAttacks);
+    slide<-1, NOT_H>(orth, empty, notOurs, counts, sliderAttacks);
+    slide<9, NOT_A>(diag, empty, notOurs, counts, sliderAttacks);
+    slide<7, NOT_H>(diag, empty, notOurs, counts, sliderAttacks);
+    slide<-7, NOT_A>(diag, empty, notOurs, counts, sliderAttacks);
+    slide<-9, NOT_H>(diag, empty, notOurs, counts, sliderAttacks);
+
+    Vec kingTargets = kingAttacks(king) & notOurs & ~danger;
+    addCounts(counts, kingTargets);
+
+    for (int i = 0; i < 4; ++i) {
+        scalar[i] = hard[i] != 0;
+        result.legalMoves[i] = counts[i];
+        result.pawnTargets[i] = pawnTargets[i];
+        result.knightTargets[i] = knightTargets[i];
+        result.kingTargets[i] = kingTargets[i];
+
+        // Not in check here, so castling only needs empty and safe transit squares
+        uint8_t rights = batch.castling[i];
+        bitboard occ = ~empty[i];
+        if ((rights & 1) && (batch.us[ROOK][i] & (1ULL << 7)) && !(occ & 0x60ULL) && !(danger[i] & 0x60ULL)) {
+            ++result.legalMoves[i];
+        }
+        if ((rights & 2) && (batch.us[ROOK][i] & 1ULL) && !(occ & 0x0EULL) && !(danger[i] & 0x0CULL)) {
+            ++result.legalMoves[i];
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+void kernelAVX2(const PositionBatch& batch, BatchResult& result, bool scalar[4]) {
+    kernel(batch, result, scalar);
+}
+
+void kernelGeneric(const PositionBatch& batch, BatchResult& result, bool scalar[4]) {
+    kernel(batch, result, scalar);
+}
+
+} // namespace
+
+void PositionBatch::push(const Board& board) {
+    assert(size < LANES);
+    int lane = size++;
+    Color side = board.getSideToMove();
+    Color enemy = static_cast<Color>(!side);
+    bool flip = side == BLACK;
+
+    for (int pt = PAWN; pt <= KING; ++pt) {
+        bitboard ours = board.getPieceBB(static_cast<Piece>(pt + 6 * side));
+        bitboard theirs = board.getPieceBB(static_cast<Piece>(pt + 6 * enemy));
+        us[pt][lane] = flip ? __builtin_bswap64(ours) : ours;
+        them[pt][lane] = flip ? __builtin_bswap64(theirs) : theirs;
+    }
+
+    castling[lane] = (board.hasCastlingRight(side, KINGSIDE) ? 1 : 0) | (board.hasCastlingRight(side, QUEENSIDE) ? 2 : 0);
+    needsScalar[lane] = board.getEpFile() != -1;
+    flipped[lane] = flip;
+    source[lane] = &board;
+}
+
+void BatchMoveGen::countLegalMoves(const PositionBatch& batch, BatchResult& result) {
+    if (batch.size == 0) return;
+
+    // Unused lanes repeat lane 0 so the kernel always sees real positions
+    PositionBatch padded;
+    const PositionBatch* input = &batch;
+    if (batch.size < PositionBatch::LANES) {
+        padded = batch;
+        while (padded.size < PositionBatch::LANES) padded.push(*batch.source[0]);
+        input = &padded;
+    }
+
+    bool scalar[PositionBatch::LANES];
+    if (Fill::hasAVX2()) {
+        kernelAVX2(*input, result, scalar);
+    } else {
+        kernelGeneric(*input, result, scalar);
+    }
+
+    for (int i = 0; i < batch.size; ++i) {
+        if (scalar[i] || input->needsScalar[i]) {
+            result.legalMoves[i] = MoveGen::countLegalMoves(*input->source[i]);
+        }
+        if (input->flipped[i]) {
+            result.pawnTargets[i] = __builtin_bswap64(result.pawnTargets[i]);
+            result.knightTargets[i] = __builtin_bswap64(result.knightTargets[i]);
+            result.kingTargets[i] = __builtin_bswap64(result.kingTargets[i]);
+        }
+    }
+}
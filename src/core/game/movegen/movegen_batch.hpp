@@ -0,0 +1,44 @@
+#pragma once
+#include "../board/board.hpp"
+
+// Structure-of-arrays block of independent positions for bulk analysis
+// (book building, labelling, EPD sweeps). Each lane is stored from the
+// side to move's point of view: black-to-move positions are mirrored
+// vertically on load, so every lane pushes pawns up the board and the
+// kernel needs no per-lane color branches.
+struct PositionBatch {
+    static constexpr int LANES = 4;
+
+    alignas(32) bitboard us[6][LANES];   // [piece type][lane], side to move
+    alignas(32) bitboard them[6][LANES];
+    uint8_t      castling[LANES];        // bit 0 kingside, bit 1 queenside, side to move only
+    bool         needsScalar[LANES];     // en passant possible: left to the scalar generator
+    bool         flipped[LANES];
+    const Board* source[LANES];
+    int          size = 0;
+
+    void clear() { size = 0; }
+    bool full() const { return size == LANES; }
+
+    // Appends a position; the board must outlive the batch
+    void push(const Board& board);
+};
+
+// Per-lane results. Target sets are in the lane's original orientation and,
+// apart from the king's, ignore pins (they are attack maps, not move lists).
+struct BatchResult {
+    int      legalMoves[PositionBatch::LANES];
+    bitboard pawnTargets[PositionBatch::LANES];   // push and capture destinations
+    bitboard knightTargets[PositionBatch::LANES];
+    bitboard kingTargets[PositionBatch::LANES];   // legal king steps, castling excluded
+};
+
+// Evaluates all lanes of a batch at once: leaper, pawn and slider target
+// sets are built with setwise shifts and Kogge-Stone fills across lanes,
+// and move counts come from per-direction popcounts. Lanes in check, with
+// a pinned piece or with en passant are rare and fall back to
+// MoveGen::countLegalMoves, so every count is exact.
+class BatchMoveGen {
+public:
+    static void countLegalMoves(const PositionBatch& batch, BatchResult& result);
+};
@@ -0,0 +1,78 @@
+#include "movegen.hpp"
+
+namespace {
+
+constexpr bitboard lsbBB(bitboard b) { return b & (0 - b); }
+
+} // namespace
+
+// Swap algorithm on a shrinking occupancy: each side in turn recaptures
+// with its least valuable attacker, and removing that attacker uncovers
+// any slider x-raying through it. `swap` is what the side to recapture
+// must win back for the exchange to miss the threshold; the loop ends as
+// soon as the outcome can no longer flip. Pins are not considered.
+bool MoveGen::see(const Board& board, Move move, int threshold) {
+    if (move.isCastle() || move.isEP() || move.isPromotion()) {
+        return 0 >= threshold;
+    }
+
+    Square from = move.from();
+    Square to = move.to();
+
+    int swap = (move.isCapture() ? PIECE_VALUES[move.captured()] : 0) - threshold;
+    if (swap < 0) {
+        return false;
+    }
+
+    swap = PIECE_VALUES[move.piece()] - swap;
+    if (swap <= 0) {
+        return true;
+    }
+
+    bitboard occupied = board.allOccupancy() ^ (1ULL << static_cast<int>(from)) ^ (1ULL << static_cast<int>(to));
+    bitboard bishopsQueens = board.bishops(WHITE) | board.bishops(BLACK) | board.queens(WHITE) | board.queens(BLACK);
+    bitboard rooksQueens = board.rooks(WHITE) | board.rooks(BLACK) | board.queens(WHITE) | board.queens(BLACK);
+    bitboard attackers = attackersTo(board, to, occupied);
+
+    Color stm = board.getSideToMove();
+    int res = 1;
+    while (true) {
+        stm = static_cast<Color>(!stm);
+        attackers &= occupied;
+
+        bitboard stmAttackers = attackers & board.occupancy(stm);
+        if (!stmAttackers) {
+            break;
+        }
+
+        res ^= 1;
+
+        bitboard bb;
+        if ((bb = stmAttackers & board.pawns(stm))) {
+            if ((swap = PIECE_VALUES[PAWN] - swap) < res) break;
+            occupied ^= lsbBB(bb);
+            attackers |= getBishopAttacks(to, occupied) & bishopsQueens;
+        } else if ((bb = stmAttackers & board.knights(stm))) {
+            if ((swap = PIECE_VALUES[KNIGHT] - swap) < res) break;
+            occupied ^= lsbBB(bb);
+        } else if ((bb = stmAttackers & board.bishops(stm))) {
+            if ((swap = PIECE_VALUES[BISHOP] - swap) < res) break;
+            occupied ^= lsbBB(bb);
+            attackers |= getBishopAttacks(to, occupied) & bishopsQueens;
+        } else if ((bb = stmAttackers & board.rooks(stm))) {
+            if ((swap = PIECE_VALUES[ROOK] - swap) < res) break;
+            occupied ^= lsbBB(bb);
+            attackers |= getRookAttacks(to, occupied) & rooksQueens;
+        } else if ((bb = stmAttackers & board.queens(stm))) {
+            if ((swap = PIECE_VALUES[QUEEN] - swap) < res) break;
+            occupied ^= lsbBB(bb);
+            attackers |= (getBishopAttacks(to, occupied) & bishopsQueens)
+                       | (getRookAttacks(to, occupied) & rooksQueens);
+        } else {
+            // Only the king is left: it may take unless the square is still defended
+            return (attackers & ~board.occupancy(stm)) ? res ^ 1 : res;
+        }
+    }
+
+    return res;
+}
@@ -0,0 +1,95 @@
+#include "perft.hpp"
+#include "perft_hash.hpp"
+#include "../movegen/movegen.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+uint64_t Perft::run(Board& board, int depth) {
+    if (depth <= 0) return 1;
+
+    // Bulk count: the last ply is popcounted from the legality masks, no moves are built
+    if (depth == 1) return MoveGen::countLegalMoves(board);
+
+    MoveList moves;
+    MoveGen::generateLegalMoves(board, moves);
+
+    uint64_t nodes = 0;
+    for (const Move& m : moves) {
+        board.makeMove(m);
+        nodes += run(board, depth - 1);
+        board.unmakeMove();
+    }
+    return nodes;
+}
+
+uint64_t Perft::divide(Board& board, int depth, std::ostream& out) {
+    if (depth <= 0) return 1;
+
+    MoveList moves;
+    MoveGen::generateLegalMoves(board, moves);
+
+    uint64_t nodes = 0;
+    for (const Move& m : moves) {
+        board.makeMove(m);
+        uint64_t count = run(board, depth - 1);
+        board.unmakeMove();
+
+        out << moveToUci(m) << ": " << count << '\n';
+        nodes += count;
+    }
+    return nodes;
+}
+
+uint64_t Perft::runHashed(Board& board, int depth, PerftHash& hash) {
+    if (depth == 1) return MoveGen::countLegalMoves(board);
+
+    // Depth-2 subtrees are cheaper to bulk count than to look up
+    uint64_t nodes = 0;
+    if (depth >= 3 && hash.probe(board.getHashKey(), depth, nodes)) return nodes;
+
+    MoveList moves;
+    MoveGen::generateLegalMoves(board, moves);
+
+    for (const Move& m : moves) {
+        board.makeMove(m);
+        nodes += runHashed(board, depth - 1, hash);
+        board.unmakeMove();
+    }
+
+    if (depth >= 3) hash.store(board.getHashKey(), depth, nodes);
+    return nodes;
+}
+
+uint64_t Perft::runParallel(const Board& board, int depth, int threads, size_t hashMb) {
+    if (depth <= 1 || (threads <= 1 && hashMb == 0)) {
+        Board copy = board;
+        return run(copy, depth);
+    }
+
+    MoveList rootMoves;
+    MoveGen::generateLegalMoves(board, rootMoves);
+
+    std::unique_ptr<PerftHash> hash = hashMb ? std::make_unique<PerftHash>(hashMb) : nullptr;
+    std::atomic<int> nextMove{0};
+    std::atomic<uint64_t> total{0};
+
+    // Workers pull root moves one at a time so uneven subtrees balance out
+    auto worker = [&]() {
+        auto local = std::make_unique<Board>(board);
+        uint64_t nodes = 0;
+        for (int i = nextMove.fetch_add(1); i < rootMoves.size(); i = nextMove.fetch_add(1)) {
+            local->makeMove(rootMoves[i]);
+            nodes += hash ? runHashed(*local, depth - 1, *hash) : run(*local, depth - 1);
+            local->unmakeMove();
+        }
+        total.fetch_add(nodes);
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (std::thread& t : pool) t.join();
+
+    return total.load();
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include "../board/board.hpp"
+
+class PerftHash;
+
+// Move path enumeration for validating and timing MoveGen and make/unmake
+class Perft {
+public:
+    // Number of leaf nodes at the given depth
+    static uint64_t run(Board& board, int depth);
+
+    // Same count, printing the subtree size under each root move
+    static uint64_t divide(Board& board, int depth, std::ostream& out);
+
+    // Root moves are handed out to `threads` workers, each playing on its
+    // own copy of the board. With hashMb > 0 all workers share a perft
+    // hash so transposed subtrees are only walked once.
+    static uint64_t runParallel(const Board& board, int depth, int threads, size_t hashMb);
+
+private:
+    static uint64_t runHashed(Board& board, int depth, PerftHash& hash);
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "../../../util/hash_entry.hpp"
+
+// Shared perft transposition table, safe to probe and store from many
+// threads without locks; each slot is a key-checked HashEntry.
+class PerftHash {
+public:
+    explicit PerftHash(size_t megabytes) {
+        size_t entries = megabytes * 1024 * 1024 / sizeof(HashEntry);
+        size_t pow2 = 1;
+        while (pow2 * 2 <= entries) pow2 *= 2;
+        mask = pow2 - 1;
+        table = std::make_unique<HashEntry[]>(pow2);
+    }
+
+    bool probe(uint64_t key, int depth, uint64_t& nodes) const noexcept {
+        uint64_t data;
+        if (!table[index(key, depth)].load(key, data) || static_cast<int>(data & DEPTH_MASK) != depth) return false;
+        nodes = data >> DEPTH_BITS;
+        return true;
+    }
+
+    void store(uint64_t key, int depth, uint64_t nodes) noexcept {
+        uint64_t data = (nodes << DEPTH_BITS) | static_cast<uint64_t>(depth);
+        table[index(key, depth)].store(key, data);
+    }
+
+private:
+    // Low byte of data is the depth, the rest the node count (up to 2^56)
+    static constexpr int      DEPTH_BITS = 8;
+    static constexpr uint64_t DEPTH_MASK = (1ULL << DEPTH_BITS) - 1;
+
+    // Mix the depth in so the same position at different depths spreads out
+    size_t index(uint64_t key, int depth) const noexcept {
+        return (key ^ (static_cast<uint64_t>(depth) * 0x9E3779B97F4A7C15ULL)) & mask;
+    }
+
+    std::unique_ptr<HashEntry[]> table;
+    size_t mask = 0;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include "../game/move/packed_move.hpp"
+
+// Quiet move ordering statistics owned by one search thread and kept
+// from one search to the next until a new game. History
+// entries move toward +-HISTORY_MAX with gravity: every update is scaled
+// down by how close the entry already is to the bound, so old results
+// fade instead of saturating.
+struct MoveHistory {
+    static constexpr int HISTORY_MAX = 16384;
+
+    // [colored piece][to]
+    using PieceToHistory = std::array<std::array<int16_t, 64>, 12>;
+
+    std::array<std::array<std::array<int16_t, 64>, 64>, 2> butterfly{};      // [color][from][to]
+    std::array<std::array<PieceToHistory, 64>, 12>          continuation{};   // [prev piece][prev to]
+    std::array<std::array<PackedMove, 64>, 12>               counterMoves{};   // [prev piece][prev to]
+
+    // Reward for a cutoff at `depth`, the same amount is taken from the
+    // quiets searched before it
+    static int bonus(int depth) { return std::min(150 * depth, 1500); }
+
+    static void update(int16_t& entry, int bonus) {
+        entry += static_cast<int16_t>(bonus - entry * std::abs(bonus) / HISTORY_MAX);
+    }
+
+    // Row by row, a whole-table temporary would not fit on the stack
+    void clear() noexcept {
+        for (auto& color : butterfly) {
+            for (auto& from : color) {
+                from.fill(0);
+            }
+        }
+        for (auto& piece : continuation) {
+            for (auto& to : piece) {
+                for (auto& row : to) {
+                    row.fill(0);
+                }
+            }
+        }
+        for (auto& piece : counterMoves) {
+            piece.fill(PackedMove());
+        }
+    }
+};
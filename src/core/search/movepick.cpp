@@ -0,0 +1,205 @@
+#include "movepick.hpp"
+#include <utility>
+#include "../game/movegen/movegen.hpp"
+
+namespace {
+
+constexpr int CAPTURE_KEY = 1 << 28;   // evasions that capture before quiet ones
+
+} // namespace
+
+MovePicker::MovePicker(const Board& board, PackedMove ttMove, const std::array<PackedMove, 2>& killers, PackedMove counter,
+                       const MoveHistory& history, const MoveHistory::PieceToHistory* cont1,
+                       const MoveHistory::PieceToHistory* cont2)
+    : board(board), history(history), cont1(cont1), cont2(cont2), us(board.getSideToMove()),
+      inCheck(MoveGen::inCheck(board)), stage(TT_MOVE), ttMove(ttMove), killers(killers), counter(counter) {
+    // Checked once here so every later stage can skip it by comparison
+    if (ttMove.isNone() || !MoveGen::isLegalMove(board, board.unpack(ttMove))) {
+        this->ttMove = PackedMove();
+        stage = inCheck ? GEN_EVASIONS : GEN_CAPTURES;
+    }
+}
+
+MovePicker::MovePicker(const Board& board, const MoveHistory& history)
+    : board(board), history(history), us(board.getSideToMove()), inCheck(MoveGen::inCheck(board)) {
+    stage = inCheck ? GEN_EVASIONS : QS_GEN_CAPTURES;
+}
+
+std::uint8_t MovePicker::captureScore(Move m) {
+    int promotion = m.isPromotion() ? 10 * m.promotion() : 0;
+    return static_cast<std::uint8_t>(10 * (m.captured() + 1) + promotion - m.piece() + KING);
+}
+
+Move MovePicker::next() {
+    while (true) {
+        switch (stage) {
+        case TT_MOVE:
+            stage = inCheck ? GEN_EVASIONS : GEN_CAPTURES;
+            return board.unpack(ttMove);
+
+        case GEN_CAPTURES:
+        case QS_GEN_CAPTURES:
+            MoveGen::generateCaptures(board, moves);
+            for (Move& m : moves) {
+                m.setScore(captureScore(m));
+            }
+            stage = stage == GEN_CAPTURES ? GOOD_CAPTURES : QS_CAPTURES;
+            break;
+
+        case GOOD_CAPTURES:
+            while (current < moves.size()) {
+                selectByScore(current);
+                Move m = moves[current++];
+                m.setScore(0);
+                if (PackedMove(m) == ttMove) {
+                    continue;
+                }
+                if (!MoveGen::see(board, m, 0)) {
+                    moves[badEnd++] = m;
+                    continue;
+                }
+                return m;
+            }
+            stage = KILLERS;
+            break;
+
+        case KILLERS:
+            while (killerIndex < 2 && !quietsSkipped) {
+                PackedMove killer = killers[killerIndex++];
+                if (!killer.isNone() && killer != ttMove && isQuietHere(killer)) {
+                    return board.unpack(killer);
+                }
+            }
+            stage = COUNTER;
+            break;
+
+        case COUNTER:
+            stage = GEN_QUIETS;
+            if (!quietsSkipped && !counter.isNone() && counter != ttMove && counter != killers[0] && counter != killers[1]
+                && isQuietHere(counter)) {
+                return board.unpack(counter);
+            }
+            break;
+
+        case GEN_QUIETS: {
+            if (quietsSkipped) {
+                current = 0;
+                stage = BAD_CAPTURES;
+                break;
+            }
+
+            // Insertion sort: quiets are only generated when most of them
+            // get searched anyway
+            int begin = moves.size();
+            MoveGen::generateQuiets(board, moves);
+            for (int i = begin; i < moves.size(); ++i) {
+                Move m = moves[i];
+                int key = quietKey(m);
+                int j = i;
+                for (; j > begin && keys[j - 1] < key; --j) {
+                    moves[j] = moves[j - 1];
+                    keys[j] = keys[j - 1];
+                }
+                moves[j] = m;
+                keys[j] = key;
+            }
+            current = begin;
+            stage = QUIETS;
+            break;
+        }
+
+        case QUIETS:
+            while (current < moves.size() && !quietsSkipped) {
+                Move m = moves[current++];
+                if (!isSpecial(m)) {
+                    return m;
+                }
+            }
+            current = 0;
+            stage = BAD_CAPTURES;
+            break;
+
+        case BAD_CAPTURES:
+            if (current < badEnd) {
+                return moves[current++];
+            }
+            stage = DONE;
+            break;
+
+        case GEN_EVASIONS:
+            MoveGen::generateEvasions(board, moves);
+            for (int i = 0; i < moves.size(); ++i) {
+                Move m = moves[i];
+                keys[i] = m.isCapture() || m.isPromotion() ? CAPTURE_KEY + captureScore(m) : quietKey(m);
+            }
+            stage = EVASIONS;
+            break;
+
+        case EVASIONS:
+            while (current < moves.size()) {
+                selectByKey(current);
+                Move m = moves[current++];
+                if (PackedMove(m) != ttMove) {
+                    return m;
+                }
+            }
+            stage = DONE;
+            break;
+
+        case QS_CAPTURES:
+            if (current < moves.size()) {
+                selectByScore(current);
+                Move m = moves[current++];
+                m.setScore(0);
+                return m;
+            }
+            stage = DONE;
+            break;
+
+        case DONE:
+            return Move();
+        }
+    }
+}
+
+int MovePicker::quietKey(Move m) const {
+    int pc = m.piece() + 6 * us;
+    int to = static_cast<int>(m.to());
+    return history.butterfly[us][static_cast<int>(m.from())][to]
+         + (cont1 ? (*cont1)[pc][to] : 0)
+         + (cont2 ? (*cont2)[pc][to] : 0);
+}
+
+bool MovePicker::isSpecial(Move m) const {
+    PackedMove packed(m);
+    return packed == ttMove || packed == killers[0] || packed == killers[1] || packed == counter;
+}
+
+// A killer or countermove from another position is only tried here when it
+// is legal and still quiet; as a capture it belongs to the capture stages
+bool MovePicker::isQuietHere(PackedMove pm) const {
+    Move m = board.unpack(pm);
+    return !m.isCapture() && !m.isPromotion() && MoveGen::isLegalMove(board, m);
+}
+
+// Swaps the highest scored move in [i, size) into slot i
+void MovePicker::selectByScore(int i) {
+    int best = i;
+    for (int j = i + 1; j < moves.size(); ++j) {
+        if (moves[j].score() > moves[best].score()) {
+            best = j;
+        }
+    }
+    std::swap(moves[i], moves[best]);
+}
+
+void MovePicker::selectByKey(int i) {
+    int best = i;
+    for (int j = i + 1; j < moves.size(); ++j) {
+        if (keys[j] > keys[best]) {
+            best = j;
+        }
+    }
+    std::swap(moves[i], moves[best]);
+    std::swap(keys[i], keys[best]);
+}
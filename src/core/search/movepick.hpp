@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "../game/board/board.hpp"
+#include "../game/move/movelist.hpp"
+#include "../game/move/packed_move.hpp"
+#include "history.hpp"
+
+// Hands out the legal moves of one node best first, generating each
+// category only once the previous ones are used up, so a cutoff by the
+// table move or a good capture never generates the quiets.
+//
+//   main search  table move, captures that do not lose material by
+//                MVV-LVA, killers, countermove, quiets by history, then
+//                the losing captures
+//   in check     table move, then every evasion with captures first
+//   quiescence   captures and promotions by MVV-LVA, or every evasion
+//
+// Captures are ordered by the score bits of Move. History needs more range
+// than those seven bits, so quiets and evasions are ordered by a key array
+// kept beside the move list.
+class MovePicker {
+public:
+    // Main search. The table move, killers and countermove come from other
+    // positions and are only returned when legal here.
+    MovePicker(const Board& board, PackedMove ttMove, const std::array<PackedMove, 2>& killers, PackedMove counter,
+               const MoveHistory& history, const MoveHistory::PieceToHistory* cont1,
+               const MoveHistory::PieceToHistory* cont2);
+
+    // Quiescence search
+    MovePicker(const Board& board, const MoveHistory& history);
+
+    // The next move, or a null move once every move was returned
+    Move next();
+
+    // Quiets not returned yet are dropped, losing captures still follow
+    void skipQuiets() noexcept { quietsSkipped = true; }
+
+    // Most valuable victim first, then least valuable attacker; queen
+    // promotions rank with winning a rook
+    static std::uint8_t captureScore(Move m);
+
+private:
+    enum Stage {
+        TT_MOVE, GEN_CAPTURES, GOOD_CAPTURES, KILLERS, COUNTER, GEN_QUIETS, QUIETS, BAD_CAPTURES,
+        GEN_EVASIONS, EVASIONS,
+        QS_GEN_CAPTURES, QS_CAPTURES,
+        DONE
+    };
+
+    int quietKey(Move m) const;
+    bool isSpecial(Move m) const;   // already tried before the quiets
+    bool isQuietHere(PackedMove pm) const;
+    void selectByScore(int i);
+    void selectByKey(int i);
+
+    const Board& board;
+    const MoveHistory& history;
+    const MoveHistory::PieceToHistory* cont1 = nullptr;
+    const MoveHistory::PieceToHistory* cont2 = nullptr;
+    Color us;
+    bool inCheck;
+
+    Stage stage;
+    PackedMove ttMove;
+    std::array<PackedMove, 2> killers{};
+    PackedMove counter;
+    int killerIndex = 0;
+    bool quietsSkipped = false;
+
+    // Captures live at the front of the list, quiets or evasions after
+    // them; losing captures are moved to [0, badEnd) as they are found
+    MoveList moves;
+    int keys[MoveList::CAPACITY];
+    int current = 0;
+    int badEnd = 0;
+};
@@ -0,0 +1,34 @@
+#include "params.hpp"
+#include <algorithm>
+
+const std::array<SearchParams::Option, 19> SearchParams::OPTIONS{{
+    {"NullMoveMinDepth",     &SearchParams::nullMoveMinDepth,     1, 20},
+    {"NullMoveBase",         &SearchParams::nullMoveBase,         1, 8},
+    {"NullMoveDepthDivisor", &SearchParams::nullMoveDepthDivisor, 1, 20},
+    {"NullMoveEvalDivisor",  &SearchParams::nullMoveEvalDivisor,  1, 2000},
+    {"NullVerifyDepth",      &SearchParams::nullVerifyDepth,      1, 128},
+    {"NullVerifyMaterial",   &SearchParams::nullVerifyMaterial,   0, 8000},
+    {"LmrMinDepth",          &SearchParams::lmrMinDepth,          1, 20},
+    {"LmrMinMoves",          &SearchParams::lmrMinMoves,          1, 64},
+    {"LmrBase",              &SearchParams::lmrBase,              0, 300},
+    {"LmrDivisor",           &SearchParams::lmrDivisor,           50, 1000},
+    {"RfpMaxDepth",          &SearchParams::rfpMaxDepth,          0, 20},
+    {"RfpMargin",            &SearchParams::rfpMargin,            0, 1000},
+    {"FutilityMaxDepth",     &SearchParams::futilityMaxDepth,     0, 20},
+    {"FutilityBase",         &SearchParams::futilityBase,         0, 1000},
+    {"FutilityMargin",       &SearchParams::futilityMargin,       0, 1000},
+    {"LmpMaxDepth",          &SearchParams::lmpMaxDepth,          0, 20},
+    {"LmpBase",              &SearchParams::lmpBase,              0, 64},
+    {"RazorMaxDepth",        &SearchParams::razorMaxDepth,        0, 20},
+    {"RazorMargin",          &SearchParams::razorMargin,          0, 2000},
+}};
+
+bool SearchParams::set(const std::string& name, int value) {
+    for (const Option& option : OPTIONS) {
+        if (name == option.name) {
+            this->*option.field = std::clamp(value, option.min, option.max);
+            return true;
+        }
+    }
+    return false;
+}
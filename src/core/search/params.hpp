@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+#include <string>
+
+// Margins and limits of the selective search. Each field is also a UCI
+// spin option that setoption accepts but the uci reply does not list, so
+// they can be tuned from a script without recompiling.
+struct SearchParams {
+    // Null move: reduce by R = base + depth / divisor + (eval - beta) / evalDivisor,
+    // the last term capped at 3. With little material left, or from
+    // verifyDepth on, a fail high is only trusted once a search without
+    // null moves for that side confirms it.
+    int nullMoveMinDepth = 3;
+    int nullMoveBase = 3;
+    int nullMoveDepthDivisor = 3;
+    int nullMoveEvalDivisor = 200;
+    int nullVerifyDepth = 8;
+    int nullVerifyMaterial = 700;     // non-pawn material at or below which zugzwang is a risk
+
+    // Late move reductions: base + ln(depth) * ln(moveNumber) / divisor, in hundredths
+    int lmrMinDepth = 3;
+    int lmrMinMoves = 3;
+    int lmrBase = 75;
+    int lmrDivisor = 225;
+
+    // Reverse futility: a static eval above beta by margin * depth fails high
+    int rfpMaxDepth = 7;
+    int rfpMargin = 80;
+
+    // Futility: quiets are skipped when eval + base + margin * depth cannot reach alpha
+    int futilityMaxDepth = 6;
+    int futilityBase = 100;
+    int futilityMargin = 100;
+
+    // Late move pruning: quiets after base + depth * depth moves are skipped
+    int lmpMaxDepth = 7;
+    int lmpBase = 3;
+
+    // Razoring: drop into quiescence when eval + margin * depth is below alpha
+    int razorMaxDepth = 3;
+    int razorMargin = 200;
+
+    struct Option {
+        const char* name;
+        int SearchParams::* field;
+        int min;
+        int max;
+    };
+    static const std::array<Option, 19> OPTIONS;
+
+    // Sets the option called `name`, clamped to its range. False if there
+    // is no such option.
+    bool set(const std::string& name, int value);
+};
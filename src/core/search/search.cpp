@@ -1 +1,794 @@
-// Search implementation will be added here
+#include "search.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include "../eval/eval.hpp"
+#include "../game/movegen/movegen.hpp"
+#include "history.hpp"
+#include "movepick.hpp"
+
+namespace {
+
+constexpr int ASPIRATION_DEPTH = 4;    // first iteration with a narrowed window
+constexpr int ASPIRATION_DELTA = 25;
+constexpr int CHECK_INTERVAL = 1024;   // nodes between clock and node limit checks
+
+constexpr int MAX_QUIETS = 64;   // quiets per node that lose history on a cutoff
+
+// Helper i skips the iterations where ((depth + phase) / size) is odd, so
+// the helpers spread over neighbouring depths instead of all searching the
+// main thread's iteration
+constexpr int SKIP_SIZE[20]  = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+constexpr int SKIP_PHASE[20] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+// Mate scores are stored relative to the node, not the root
+int scoreToTT(int score, int ply) {
+    if (score >= Search::MATE_BOUND) return score + ply;
+    if (score <= -Search::MATE_BOUND) return score - ply;
+    return score;
+}
+
+int scoreFromTT(int score, int ply) {
+    if (score >= Search::MATE_BOUND) return score - ply;
+    if (score <= -Search::MATE_BOUND) return score + ply;
+    return score;
+}
+
+// Index of the side to move's piece in the history tables
+constexpr int coloredPiece(Move m, Color us) {
+    return m.piece() + 6 * us;
+}
+
+int nonPawnMaterial(const Board& board, Color side) {
+    return PIECE_VALUES[KNIGHT] * __builtin_popcountll(board.knights(side))
+         + PIECE_VALUES[BISHOP] * __builtin_popcountll(board.bishops(side))
+         + PIECE_VALUES[ROOK] * __builtin_popcountll(board.rooks(side))
+         + PIECE_VALUES[QUEEN] * __builtin_popcountll(board.queens(side));
+}
+
+} // namespace
+
+// Per-thread search state: board copy, PV tables and counters. Only the
+// main worker (id 0) reads the clock, prints and raises the shared stop.
+class Search::Worker {
+public:
+    Worker(Search& search, int id) : search(search), id(id), history(std::make_unique<MoveHistory>()) {}
+
+    void iterate(const Board& root, Move fallback, int maxDepth);
+    void printInfo() const;
+
+    uint64_t nodeCount() const noexcept { return nodes.load(std::memory_order_relaxed); }
+    uint64_t qnodeCount() const noexcept { return qnodes; }
+    uint64_t cutoffCount() const noexcept { return cutoffs; }
+    uint64_t firstMoveCutoffCount() const noexcept { return firstMoveCutoffs; }
+    void clearHistory() noexcept { history->clear(); }
+
+    // Outcome of the last completed iteration
+    Move bestMove;
+    int  score = 0;
+    int  completedDepth = 0;
+    double branchingFactor = 0.0;   // main worker only
+
+private:
+    int pvs(Board& board, int alpha, int beta, int depth, int ply);
+    int qsearch(Board& board, int alpha, int beta, int ply);
+    void updateQuietStats(const Board& board, int ply, int depth, Move best, const Move* quiets, int quietCount);
+    void updateQuietHistory(Color us, int ply, Move move, int bonus);
+    bool shouldStop();
+
+    Search& search;
+    const int id;
+    Board board;
+
+    // Triangular PV table: row `ply` holds the best line from that ply on
+    std::array<std::array<PackedMove, MAX_PLY>, MAX_PLY> pvTable;
+    std::array<int, MAX_PLY> pvLength{};
+
+    // Line of the last completed iteration, its first move leads the next
+    // iteration when the table lost the root entry
+    std::array<PackedMove, MAX_PLY> rootPv{};
+    int rootPvLength = 0;
+
+    // Move ordering: statistics kept for the whole search, two killer
+    // quiets per ply and the continuation history row of the move played
+    // at each ply, null where there is none
+    std::unique_ptr<MoveHistory> history;
+    std::array<std::array<PackedMove, 2>, MAX_PLY> killers{};
+    std::array<MoveHistory::PieceToHistory*, MAX_PLY> contHistory{};
+
+    // Static eval of each node on the current line, VALUE_NONE in check
+    std::array<int, MAX_PLY> staticEvals{};
+
+    // While verifying a null move fail high, nmpColor may not pass the
+    // turn again before nmpMinPly
+    int nmpMinPly = 0;
+    Color nmpColor = WHITE;
+
+    std::atomic<uint64_t> nodes{0};   // written by the owner, summed by the main worker
+    uint64_t qnodes = 0;              // part of nodes spent in qsearch
+    uint64_t cutoffs = 0;             // move ordering quality: fail highs and
+    uint64_t firstMoveCutoffs = 0;    // how many of them the first move caused
+    int selDepth = 0;
+    bool stopped = false;
+    int checkCountdown = 1;
+
+    // Nodes of the last root search pass and the part spent below its best move
+    uint64_t rootPassStart = 0;
+    uint64_t bestMoveNodes = 0;
+};
+
+Search::Search(TranspositionTable& tt, std::ostream& out, int threads, const SearchParams& params)
+    : params(params), tt(tt), out(out) {
+    initReductions();
+    for (int i = 0; i < std::max(threads, 1); ++i) {
+        workers.push_back(std::make_unique<Worker>(*this, i));
+    }
+}
+
+void Search::initReductions() {
+    for (int depth = 0; depth < 64; ++depth) {
+        for (int move = 0; move < 64; ++move) {
+            reductions[depth][move] = depth && move
+                ? static_cast<int>(params.lmrBase / 100.0 + std::log(depth) * std::log(move) * 100.0 / params.lmrDivisor)
+                : 0;
+        }
+    }
+}
+
+void Search::clearHistory() {
+    wait();
+    for (auto& w : workers) {
+        w->clearHistory();
+    }
+}
+
+void Search::setParams(const SearchParams& searchParams) {
+    wait();
+    params = searchParams;
+    initReductions();
+}
+
+Search::~Search() {
+    requestStop();
+    wait();
+}
+
+void Search::start(const Board& board, const SearchLimits& searchLimits, DoneCallback callback) {
+    wait();
+
+    // All shared state is reset before the thread exists, so a stop or
+    // ponderhit sent right after go cannot be lost
+    rootBoard = board;
+    limits = searchLimits;
+    onDone = std::move(callback);
+    time.init(limits, board.getSideToMove());
+    stop = false;
+    pondering = limits.ponder;
+
+    mainThread = std::thread([this] {
+        think();
+        if (onDone) {
+            onDone(result);
+        }
+    });
+}
+
+SearchResult Search::wait() {
+    if (mainThread.joinable()) {
+        mainThread.join();
+    }
+    return result;
+}
+
+SearchResult Search::run(const Board& board, const SearchLimits& searchLimits) {
+    start(board, searchLimits);
+    return wait();
+}
+
+void Search::think() {
+    tt.newSearch();
+    result = SearchResult();
+
+    MoveList rootMoves;
+    MoveGen::generateLegalMoves(rootBoard, rootMoves);
+    if (rootMoves.empty()) {
+        waitForStopIfRequired();
+        return;
+    }
+
+    int maxDepth = limits.depth > 0 ? std::min(limits.depth, MAX_PLY - 1) : MAX_PLY - 1;
+
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < workers.size(); ++i) {
+        helpers.emplace_back([&, i] { workers[i]->iterate(rootBoard, rootMoves[0], maxDepth); });
+    }
+    workers[0]->iterate(rootBoard, rootMoves[0], maxDepth);
+
+    waitForStopIfRequired();
+
+    stop = true;
+    for (std::thread& t : helpers) {
+        t.join();
+    }
+
+    const Worker& best = pickBestWorker();
+    if (&best != workers[0].get()) {
+        best.printInfo();
+    }
+
+    result.bestMove = best.bestMove;
+    result.score = best.score;
+    result.depth = best.completedDepth;
+    result.nodes = totalNodes();
+    result.branchingFactor = workers[0]->branchingFactor;
+    for (const auto& w : workers) {
+        result.qnodes += w->qnodeCount();
+        result.cutoffs += w->cutoffCount();
+        result.firstMoveCutoffs += w->firstMoveCutoffCount();
+    }
+}
+
+void Search::waitForStopIfRequired() {
+    std::unique_lock<std::mutex> lock(waitMutex);
+    waitCv.wait(lock, [&] { return stop || (!pondering && !limits.infinite); });
+}
+
+void Search::requestStop() {
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        stop = true;
+    }
+    waitCv.notify_all();
+}
+
+void Search::ponderhit() {
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        pondering = false;
+    }
+    waitCv.notify_all();
+}
+
+uint64_t Search::totalNodes() const noexcept {
+    uint64_t total = 0;
+    for (const auto& w : workers) {
+        total += w->nodeCount();
+    }
+    return total;
+}
+
+// Each thread votes for its move, weighted by how far it searched and how
+// much better its score is than the worst one. A found mate always wins,
+// the shortest one first.
+const Search::Worker& Search::pickBestWorker() const {
+    const Worker* best = workers[0].get();
+    if (workers.size() == 1) {
+        return *best;
+    }
+
+    int minScore = INF;
+    for (const auto& w : workers) {
+        if (w->completedDepth) {
+            minScore = std::min(minScore, w->score);
+        }
+    }
+
+    std::unordered_map<uint32_t, int64_t> votes;
+    for (const auto& w : workers) {
+        if (w->completedDepth) {
+            votes[w->bestMove.value] += static_cast<int64_t>(w->score - minScore + 14) * w->completedDepth;
+        }
+    }
+
+    for (const auto& w : workers) {
+        if (!w->completedDepth) {
+            continue;
+        }
+        if (best->score >= MATE_BOUND) {
+            if (w->score > best->score) {
+                best = w.get();
+            }
+        } else if (w->score >= MATE_BOUND || votes[w->bestMove.value] > votes[best->bestMove.value]) {
+            best = w.get();
+        }
+    }
+    return *best;
+}
+
+void Search::Worker::iterate(const Board& root, Move fallback, int maxDepth) {
+    board = root;
+    nodes = 0;
+    qnodes = 0;
+    cutoffs = 0;
+    firstMoveCutoffs = 0;
+    stopped = false;
+    rootPvLength = 0;
+    killers = {};
+    nmpMinPly = 0;
+    bestMove = fallback;  // kept if the first iteration is cut short
+    score = 0;
+    completedDepth = 0;
+    checkCountdown = 1;
+
+    branchingFactor = 0.0;
+
+    bool singleReply = MoveGen::countLegalMoves(board) == 1;
+    double bestMoveChanges = 0.0;
+    uint64_t previousIterationNodes = 0;
+
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        if (id > 0) {
+            int i = (id - 1) % 20;
+            if (((depth + SKIP_PHASE[i]) / SKIP_SIZE[i]) % 2) {
+                continue;
+            }
+        }
+        selDepth = 0;
+
+        int delta = ASPIRATION_DELTA;
+        int alpha = -INF, beta = INF;
+        if (depth >= ASPIRATION_DEPTH) {
+            alpha = std::max(score - delta, -INF);
+            beta = std::min(score + delta, INF);
+        }
+
+        // Widen the side that failed until the score lands inside the window
+        int iterationScore;
+        while (true) {
+            iterationScore = pvs(board, alpha, beta, depth, 0);
+            if (stopped) {
+                break;
+            }
+            if (iterationScore <= alpha) {
+                beta = (alpha + beta) / 2;
+                alpha = std::max(iterationScore - delta, -INF);
+            } else if (iterationScore >= beta) {
+                beta = std::min(iterationScore + delta, INF);
+            } else {
+                break;
+            }
+            delta *= 2;
+        }
+
+        // A partial iteration is discarded
+        if (stopped) {
+            break;
+        }
+
+        int previousScore = score;
+        Move previousBest = bestMove;
+
+        score = iterationScore;
+        rootPvLength = pvLength[0];
+        std::copy_n(pvTable[0].begin(), rootPvLength, rootPv.begin());
+        bestMove = board.unpack(rootPv[0]);
+        completedDepth = depth;
+
+        if (id != 0) {
+            continue;
+        }
+        uint64_t iterationNodes = search.totalNodes();
+        if (previousIterationNodes) {
+            branchingFactor = static_cast<double>(iterationNodes) / previousIterationNodes;
+        }
+        previousIterationNodes = iterationNodes;
+        printInfo();
+
+        // Nothing deeper changes a forced mate we can already see
+        if (std::abs(score) >= MATE_BOUND && MATE - std::abs(score) <= depth) {
+            break;
+        }
+        if (search.limits.mate && score >= MATE_BOUND && (MATE - score + 1) / 2 <= search.limits.mate) {
+            break;
+        }
+
+        const TimeManager& time = search.time;
+        if (!time.enabled() || search.pondering.load(std::memory_order_relaxed)) {
+            continue;
+        }
+        if (singleReply) {
+            break;
+        }
+
+        // Spend longer while the best move keeps changing or the score is
+        // falling, less when one move takes nearly all the effort
+        bestMoveChanges = bestMoveChanges / 2 + (bestMove != previousBest && depth > 1);
+        double instability = 1.0 + 0.5 * bestMoveChanges;
+        double falling = depth > 1 ? std::clamp(1.0 + (previousScore - score) / 200.0, 0.75, 1.5) : 1.0;
+        double effort = static_cast<double>(bestMoveNodes) / std::max<uint64_t>(nodeCount() - rootPassStart, 1);
+        double dominance = std::clamp(1.6 - effort, 0.6, 1.2);
+
+        if (time.softExceeded(instability * falling * dominance)) {
+            break;
+        }
+    }
+}
+
+int Search::Worker::pvs(Board& board, int alpha, int beta, int depth, int ply) {
+    if (depth <= 0) {
+        return qsearch(board, alpha, beta, ply);
+    }
+
+    pvLength[ply] = ply;
+    if (shouldStop()) {
+        return 0;
+    }
+
+    nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    selDepth = std::max(selDepth, ply);
+
+    if (ply > 0 && (board.getHalfmoveClock() >= 100 || board.isRepetition())) {
+        return 0;
+    }
+
+    if (ply >= MAX_PLY - 1) {
+        return Eval::evaluate(board);
+    }
+
+    TranspositionTable& tt = search.tt;
+    bool pvNode = beta - alpha > 1;
+    uint64_t key = board.getHashKey();
+    TranspositionTable::Data entry;
+    bool ttHit = tt.probe(key, entry);
+
+    // Bounds from an earlier search at least as deep settle non-PV nodes
+    if (ttHit && !pvNode && ply > 0 && entry.depth >= depth) {
+        int ttScore = scoreFromTT(entry.score, ply);
+        if (entry.bound == TranspositionTable::BOUND_EXACT
+            || (entry.bound == TranspositionTable::BOUND_LOWER && ttScore >= beta)
+            || (entry.bound == TranspositionTable::BOUND_UPPER && ttScore <= alpha)) {
+            return ttScore;
+        }
+    }
+
+    const SearchParams& params = search.params;
+    Color us = board.getSideToMove();
+    bool inCheck = MoveGen::inCheck(board);
+
+    int staticEval = VALUE_NONE;
+    if (!inCheck) {
+        staticEval = ttHit && entry.eval != VALUE_NONE ? entry.eval : Eval::evaluate(board);
+    }
+    staticEvals[ply] = staticEval;
+    bool improving = !inCheck && ply >= 2 && staticEvals[ply - 2] != VALUE_NONE && staticEval > staticEvals[ply - 2];
+
+    // Node pruning, only where a wrong guess cannot change the PV
+    if (!pvNode && !inCheck && ply > 0 && std::abs(beta) < MATE_BOUND) {
+        // Reverse futility: too far above beta to fall back below it
+        if (depth <= params.rfpMaxDepth && staticEval - params.rfpMargin * (depth - improving) >= beta) {
+            return staticEval;
+        }
+
+        // Razoring: too far below alpha for anything but a capture to help
+        if (depth <= params.razorMaxDepth && staticEval + params.razorMargin * depth <= alpha) {
+            int score = qsearch(board, alpha, alpha + 1, ply);
+            if (stopped) {
+                return 0;
+            }
+            if (score <= alpha) {
+                return score;
+            }
+        }
+
+        // Null move: if passing still fails high, a real move will too.
+        // Not twice in a row and not without pieces, where zugzwang is
+        // common; in thin material or at high depth the fail high has to
+        // survive a reduced search without null moves for this side.
+        int material = nonPawnMaterial(board, us);
+        if (depth >= params.nullMoveMinDepth && staticEval >= beta && material && !board.lastMove().isNone()
+            && (ply >= nmpMinPly || us != nmpColor)) {
+            int reduction = params.nullMoveBase + depth / params.nullMoveDepthDivisor
+                          + std::min((staticEval - beta) / params.nullMoveEvalDivisor, 3);
+            int nullDepth = std::max(depth - 1 - reduction, 0);
+
+            contHistory[ply] = nullptr;
+            board.makeNullMove();
+            int score = -pvs(board, -beta, -beta + 1, nullDepth, ply + 1);
+            board.unmakeNullMove();
+            if (stopped) {
+                return 0;
+            }
+
+            if (score >= beta) {
+                score = std::min(score, MATE_BOUND - 1);   // a mate found by passing proves nothing
+                if (material > params.nullVerifyMaterial && depth < params.nullVerifyDepth) {
+                    return score;
+                }
+
+                // Restored afterwards, this may run inside the other side's
+                // verification
+                int outerMinPly = nmpMinPly;
+                Color outerColor = nmpColor;
+                nmpMinPly = ply + 3 * nullDepth / 4 + 1;
+                nmpColor = us;
+                int verified = pvs(board, beta - 1, beta, nullDepth, ply);
+                nmpMinPly = outerMinPly;
+                nmpColor = outerColor;
+                if (stopped) {
+                    return 0;
+                }
+                if (verified >= beta) {
+                    return score;
+                }
+            }
+        }
+    }
+
+    PackedMove ttMove = ttHit ? entry.move : PackedMove();
+    if (ttMove.isNone() && ply == 0 && rootPvLength) {
+        ttMove = rootPv[0];
+    }
+
+    PackedMove counter;
+    PackedMove previous = board.lastMove();
+    if (!previous.isNone()) {
+        counter = history->counterMoves[board.pieceAt(previous.to())][static_cast<int>(previous.to())];
+    }
+    MovePicker picker(board, ttMove, killers[ply], counter, *history,
+                      ply >= 1 ? contHistory[ply - 1] : nullptr, ply >= 2 ? contHistory[ply - 2] : nullptr);
+
+    if (ply == 0) {
+        rootPassStart = nodeCount();
+        bestMoveNodes = 0;
+    }
+
+    Move quiets[MAX_QUIETS];
+    int quietCount = 0;
+
+    int oldAlpha = alpha;
+    int bestScore = -INF;
+    Move best;
+    int moveCount = 0;
+    for (Move move = picker.next(); !move.isNone(); move = picker.next()) {
+        ++moveCount;
+        bool quiet = !move.isCapture() && !move.isPromotion();
+
+        // Move pruning: once a line that avoids mate exists, late quiets
+        // and quiets that cannot lift a hopeless eval to alpha are skipped
+        if (ply > 0 && !inCheck && quiet && bestScore > -MATE_BOUND) {
+            if (depth <= params.lmpMaxDepth && moveCount > params.lmpBase + depth * depth) {
+                picker.skipQuiets();
+                continue;
+            }
+            if (depth <= params.futilityMaxDepth
+                && staticEval + params.futilityBase + params.futilityMargin * depth <= alpha) {
+                picker.skipQuiets();
+                continue;
+            }
+        }
+
+        uint64_t nodesBefore = nodeCount();
+
+        contHistory[ply] = &history->continuation[coloredPiece(move, us)][static_cast<int>(move.to())];
+        board.makeMove(move);
+        tt.prefetch(board.getHashKey());
+        int score;
+        if (moveCount == 1) {
+            score = -pvs(board, -beta, -alpha, depth - 1, ply + 1);
+        } else {
+            // Late quiets are searched shallower first, and again at full
+            // depth only if they beat alpha. Checks are not reduced.
+            int reduction = 0;
+            if (depth >= params.lmrMinDepth && moveCount > params.lmrMinMoves && quiet && !inCheck
+                && !MoveGen::inCheck(board)) {
+                reduction = search.reductions[std::min(depth, 63)][std::min(moveCount, 63)];
+                reduction += !improving - pvNode;
+                reduction = std::clamp(reduction, 0, depth - 2);
+            }
+
+            // Later moves only have to be proven worse than the first one;
+            // a null window search suffices unless one turns out better
+            score = -pvs(board, -alpha - 1, -alpha, depth - 1 - reduction, ply + 1);
+            if (reduction && score > alpha) {
+                score = -pvs(board, -alpha - 1, -alpha, depth - 1, ply + 1);
+            }
+            if (pvNode && score > alpha && score < beta) {
+                score = -pvs(board, -beta, -alpha, depth - 1, ply + 1);
+            }
+        }
+        board.unmakeMove();
+
+        if (stopped) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                best = move;
+                if (ply == 0) {
+                    bestMoveNodes = nodeCount() - nodesBefore;
+                }
+
+                pvTable[ply][ply] = move;
+                for (int next = ply + 1; next < pvLength[ply + 1]; ++next) {
+                    pvTable[ply][next] = pvTable[ply + 1][next];
+                }
+                pvLength[ply] = pvLength[ply + 1];
+
+                if (alpha >= beta) {
+                    ++cutoffs;
+                    firstMoveCutoffs += moveCount == 1;
+                    if (quiet) {
+                        updateQuietStats(board, ply, depth, move, quiets, quietCount);
+                    }
+                    break;
+                }
+            }
+        }
+
+        if (quiet && quietCount < MAX_QUIETS) {
+            quiets[quietCount++] = move;
+        }
+    }
+
+    if (!moveCount) {
+        return inCheck ? -MATE + ply : 0;
+    }
+
+    TranspositionTable::Bound bound = bestScore >= beta ? TranspositionTable::BOUND_LOWER
+                                    : alpha > oldAlpha ? TranspositionTable::BOUND_EXACT
+                                    : TranspositionTable::BOUND_UPPER;
+    tt.store(key, best, scoreToTT(bestScore, ply), staticEval, depth, bound);
+
+    return bestScore;
+}
+
+// Captures and promotions until the position is quiet. The side to move
+// may stand pat on the static eval unless in check, where every evasion is
+// searched so mates are still seen. Captures that lose material by SEE are
+// skipped.
+int Search::Worker::qsearch(Board& board, int alpha, int beta, int ply) {
+    pvLength[ply] = ply;
+    if (shouldStop()) {
+        return 0;
+    }
+
+    nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    ++qnodes;
+    selDepth = std::max(selDepth, ply);
+
+    if (ply >= MAX_PLY - 1) {
+        return Eval::evaluate(board);
+    }
+
+    bool inCheck = MoveGen::inCheck(board);
+    int bestScore = -INF;
+    if (!inCheck) {
+        bestScore = Eval::evaluate(board);
+        if (bestScore >= beta) {
+            return bestScore;
+        }
+        alpha = std::max(alpha, bestScore);
+    }
+
+    MovePicker picker(board, *history);
+    for (Move move = picker.next(); !move.isNone(); move = picker.next()) {
+        if (!inCheck && !MoveGen::see(board, move, 0)) {
+            continue;
+        }
+
+        board.makeMove(move);
+        int score = -qsearch(board, -beta, -alpha, ply + 1);
+        board.unmakeMove();
+
+        if (stopped) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+
+                pvTable[ply][ply] = move;
+                for (int next = ply + 1; next < pvLength[ply + 1]; ++next) {
+                    pvTable[ply][next] = pvTable[ply + 1][next];
+                }
+                pvLength[ply] = pvLength[ply + 1];
+
+                if (alpha >= beta) {
+                    break;
+                }
+            }
+        }
+    }
+
+    // Every evasion was searched, none found means mate
+    if (inCheck && bestScore == -INF) {
+        return -MATE + ply;
+    }
+    return bestScore;
+}
+
+// A quiet move caused a cutoff: it becomes a killer and the reply to the
+// previous move, and gains history while the quiets tried before it lose
+// the same amount
+void Search::Worker::updateQuietStats(const Board& board, int ply, int depth, Move best,
+                                      const Move* quiets, int quietCount) {
+    if (killers[ply][0] != PackedMove(best)) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = best;
+    }
+
+    PackedMove previous = board.lastMove();
+    if (!previous.isNone()) {
+        history->counterMoves[board.pieceAt(previous.to())][static_cast<int>(previous.to())] = best;
+    }
+
+    Color us = board.getSideToMove();
+    int bonus = MoveHistory::bonus(depth);
+    updateQuietHistory(us, ply, best, bonus);
+    for (int i = 0; i < quietCount; ++i) {
+        updateQuietHistory(us, ply, quiets[i], -bonus);
+    }
+}
+
+void Search::Worker::updateQuietHistory(Color us, int ply, Move move, int bonus) {
+    int pc = coloredPiece(move, us);
+    int to = static_cast<int>(move.to());
+    MoveHistory::update(history->butterfly[us][static_cast<int>(move.from())][to], bonus);
+    if (ply >= 1 && contHistory[ply - 1]) {
+        MoveHistory::update((*contHistory[ply - 1])[pc][to], bonus);
+    }
+    if (ply >= 2 && contHistory[ply - 2]) {
+        MoveHistory::update((*contHistory[ply - 2])[pc][to], bonus);
+    }
+}
+
+// The main worker polls the limits every CHECK_INTERVAL nodes, or sooner
+// when a node limit is close; everyone else only reads the stop flag
+bool Search::Worker::shouldStop() {
+    if (stopped) {
+        return true;
+    }
+
+    if (id == 0 && --checkCountdown <= 0) {
+        checkCountdown = CHECK_INTERVAL;
+        if (!search.pondering.load(std::memory_order_relaxed)) {
+            const SearchLimits& limits = search.limits;
+            if (limits.nodes) {
+                uint64_t total = search.totalNodes();
+                if (total >= limits.nodes) {
+                    search.stop = true;
+                } else {
+                    uint64_t perWorker = (limits.nodes - total) / search.workers.size();
+                    checkCountdown = static_cast<int>(std::clamp<uint64_t>(perWorker, 1, CHECK_INTERVAL));
+                }
+            }
+            if (search.time.hardExceeded()) {
+                search.stop = true;
+            }
+        }
+    }
+
+    stopped = search.stop.load(std::memory_order_relaxed);
+    return stopped;
+}
+
+void Search::Worker::printInfo() const {
+    auto elapsed = search.time.elapsed();
+    uint64_t total = search.totalNodes();
+
+    // One write per line so replies from the UCI thread cannot split it
+    std::ostringstream out;
+    out << "info depth " << completedDepth << " seldepth " << selDepth;
+    if (std::abs(score) >= MATE_BOUND) {
+        int movesToMate = score > 0 ? (MATE - score + 1) / 2 : -(MATE + score) / 2;
+        out << " score mate " << movesToMate;
+    } else {
+        out << " score cp " << score;
+    }
+    out << " nodes " << total << " nps " << total * 1000 / (elapsed + 1) << " hashfull " << search.tt.hashfull()
+        << " time " << elapsed << " pv";
+    for (int i = 0; i < rootPvLength; ++i) {
+        out << ' ' << moveToUci(rootPv[i]);
+    }
+    out << '\n';
+    search.out << out.str() << std::flush;
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+#include "../game/board/board.hpp"
+#include "../game/move/movelist.hpp"
+#include "params.hpp"
+#include "timeman.hpp"
+#include "tt.hpp"
+
+// Limits from the UCI go command, 0 means unlimited. Times in milliseconds.
+struct SearchLimits {
+    int      depth = 0;
+    uint64_t nodes = 0;
+    int      mate = 0;          // stop once a mate in this many moves is found
+    int64_t  moveTimeMs = 0;
+    int64_t  wtime = 0, btime = 0;
+    int64_t  winc = 0, binc = 0;
+    int      movesToGo = 0;
+    int64_t  moveOverheadMs = 0;  // reserved per move for GUI and transport lag
+    bool     infinite = false;  // run until stop, even past a depth limit
+    bool     ponder = false;    // like infinite until ponderhit
+};
+
+struct SearchResult {
+    Move     bestMove;
+    int      score = 0;
+    int      depth = 0;
+    uint64_t nodes = 0;
+    uint64_t qnodes = 0;   // of which in quiescence search
+    uint64_t cutoffs = 0;            // fail-high nodes in the main search
+    uint64_t firstMoveCutoffs = 0;   // of which by the first move searched
+    double   branchingFactor = 0.0;  // nodes to finish the last iteration over those to finish the one before
+};
+
+// Iterative deepening principal variation search. Each iteration searches
+// inside an aspiration window around the previous score and prints a UCI
+// info line with the principal variation when it completes.
+//
+// With more than one thread the search is Lazy SMP: every thread runs the
+// same iterative deepening on its own board copy, the threads only share
+// the transposition table, and helpers skip some depths so they spread
+// over different iterations. When the main thread stops, the threads vote
+// on the move to play.
+class Search {
+public:
+    static constexpr int MAX_PLY = 128;
+    static constexpr int INF = 32000;
+    static constexpr int MATE = 31000;
+    static constexpr int MATE_BOUND = MATE - MAX_PLY;  // scores beyond this are mates
+    static constexpr int VALUE_NONE = INF + 1;
+
+    Search(TranspositionTable& tt, std::ostream& out, int threads = 1, const SearchParams& params = SearchParams());
+    ~Search();
+
+    using DoneCallback = std::function<void(const SearchResult&)>;
+
+    // Copies the position and starts searching on a background thread.
+    // onDone runs on that thread once the result is known. With infinite or
+    // ponder limits the search does not finish before requestStop, or
+    // before ponderhit and then its limits.
+    void start(const Board& board, const SearchLimits& limits, DoneCallback onDone = {});
+
+    // Joins the search thread and returns its result
+    SearchResult wait();
+
+    // start followed by wait
+    SearchResult run(const Board& board, const SearchLimits& limits);
+
+    // Both are safe to call from another thread while a search is running
+    void requestStop();
+    void ponderhit();
+
+    // Move ordering history carries over between searches of one game.
+    // Both wait for a running search to finish first.
+    void clearHistory();
+    void setParams(const SearchParams& params);
+
+private:
+    class Worker;
+
+    void think();
+
+    // UCI forbids a bestmove before stop while pondering or searching
+    // infinitely, so think() holds its result here until then
+    void waitForStopIfRequired();
+
+    void initReductions();
+    uint64_t totalNodes() const noexcept;
+    const Worker& pickBestWorker() const;
+
+    std::vector<std::unique_ptr<Worker>> workers;   // [0] runs on the caller's thread
+
+    Board rootBoard;
+    SearchLimits limits;
+    SearchResult result;
+    DoneCallback onDone;
+    std::thread mainThread;
+
+    TimeManager time;
+    std::atomic<bool> stop{false};       // polled by every worker at each node
+    std::atomic<bool> pondering{false};  // limits are ignored while set
+
+    // Wakes a finished search that is waiting for stop or ponderhit
+    std::mutex waitMutex;
+    std::condition_variable waitCv;
+
+    // Late move reductions by [depth][move number], from params
+    SearchParams params;
+    std::array<std::array<int, 64>, 64> reductions;
+
+    TranspositionTable& tt;
+    std::ostream& out;
+};
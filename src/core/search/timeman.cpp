@@ -0,0 +1,52 @@
+#include "timeman.hpp"
+#include <algorithm>
+#include "search.hpp"
+
+namespace {
+
+constexpr int DEFAULT_MOVES_TO_GO = 40;  // expected moves left without movestogo
+constexpr int MAX_MOVES_TO_GO = 50;
+constexpr int HARD_TO_SOFT = 3;          // hard limit as a multiple of the soft one
+
+} // namespace
+
+void TimeManager::init(const SearchLimits& limits, util::Color us) {
+    start = std::chrono::steady_clock::now();
+
+    int64_t clock = us == util::WHITE ? limits.wtime : limits.btime;
+    int64_t inc = us == util::WHITE ? limits.winc : limits.binc;
+
+    if (limits.moveTimeMs) {
+        timed = true;
+        flexible = false;
+        soft = hard = std::max<int64_t>(limits.moveTimeMs - limits.moveOverheadMs, 1);
+        return;
+    }
+    // A clock for either side means a timed game; a missing own clock
+    // counts as empty and gets the minimum budget
+    if (!limits.wtime && !limits.btime) {
+        timed = false;
+        return;
+    }
+
+    timed = true;
+    flexible = true;
+    int64_t available = std::max<int64_t>(clock - limits.moveOverheadMs, 1);
+    int movesToGo = limits.movesToGo ? std::min(limits.movesToGo, MAX_MOVES_TO_GO) : DEFAULT_MOVES_TO_GO;
+
+    // Even share of what is left plus most of the increment. A single
+    // iteration may overrun that, but never by more than a slice of the
+    // clock: nearly all of it on the last move before a time control.
+    soft = available / movesToGo + inc * 3 / 4;
+    int64_t ceiling = movesToGo == 1 ? available * 9 / 10 : available / 5;
+    hard = std::max<int64_t>(std::min(soft * HARD_TO_SOFT, ceiling), 1);
+    soft = std::clamp<int64_t>(soft, 1, hard);
+}
+
+bool TimeManager::softExceeded(double scale) const noexcept {
+    if (!timed || !flexible) {
+        return false;
+    }
+    int64_t budget = std::min(static_cast<int64_t>(soft * scale), hard);
+    return elapsed() >= budget;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include "../../util/util.hpp"
+
+struct SearchLimits;
+
+// Turns the go command's clock into two budgets. The soft limit is checked
+// between iterations and scaled by how settled the search looks; the hard
+// limit is polled inside the search and is never exceeded by more than one
+// polling interval.
+class TimeManager {
+public:
+    // Starts the clock. Without movetime or a clock for either side the
+    // search is not time limited.
+    void init(const SearchLimits& limits, util::Color us);
+
+    bool enabled() const noexcept { return timed; }
+    int64_t softLimit() const noexcept { return soft; }
+    int64_t hardLimit() const noexcept { return hard; }
+
+    int64_t elapsed() const noexcept {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    bool hardExceeded() const noexcept { return timed && elapsed() >= hard; }
+
+    // True once the soft budget times `scale` is used up, capped by the hard
+    // limit. A fixed movetime has no soft budget.
+    bool softExceeded(double scale) const noexcept;
+
+private:
+    std::chrono::steady_clock::time_point start;
+    bool    timed = false;
+    bool    flexible = false;   // clock time, may end between iterations
+    int64_t soft = 0;
+    int64_t hard = 0;
+};
@@ -0,0 +1,89 @@
+#include "tt.hpp"
+#include <algorithm>
+#include <climits>
+
+void TranspositionTable::resize(size_t mb) {
+    megabytes = std::max<size_t>(mb, 1);
+    bucketCount = megabytes * 1024 * 1024 / sizeof(Bucket);
+    buckets.reset();
+    buckets = std::make_unique<Bucket[]>(bucketCount);
+    generation = 0;
+}
+
+void TranspositionTable::clear() noexcept {
+    for (size_t i = 0; i < bucketCount; ++i) {
+        for (HashEntry& e : buckets[i].entries) {
+            e.clear();
+        }
+    }
+    generation = 0;
+}
+
+bool TranspositionTable::probe(uint64_t key, Data& out) const noexcept {
+    const Bucket& bucket = buckets[index(key)];
+    for (const HashEntry& e : bucket.entries) {
+        uint64_t data;
+        if (e.load(key, data) && (data >> GENERATION_SHIFT & 0x3) != BOUND_NONE) {
+            out = unpack(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, PackedMove move, int score, int eval, int depth, Bound bound) noexcept {
+    Bucket& bucket = buckets[index(key)];
+
+    // Same position first; otherwise the entry with the least depth left
+    // once older generations are discounted
+    HashEntry* victim = nullptr;
+    int victimValue = INT_MAX;
+    for (HashEntry& e : bucket.entries) {
+        uint64_t data;
+        bool sameKey = e.load(key, data);
+        Data old = unpack(data);
+        uint8_t oldGeneration = static_cast<uint8_t>(data >> GENERATION_SHIFT) & GENERATION_MASK;
+
+        if (old.bound == BOUND_NONE) {
+            if (victimValue > INT_MIN) {
+                victim = &e;
+                victimValue = INT_MIN;
+            }
+            continue;
+        }
+
+        if (sameKey) {
+            // A deeper bound from this search is worth more than a shallow one
+            if (bound != BOUND_EXACT && oldGeneration == generation && depth + 2 < old.depth) {
+                return;
+            }
+            if (move.isNone()) {
+                move = old.move;
+            }
+            victim = &e;
+            break;
+        }
+
+        int age = ((generation - oldGeneration) & GENERATION_MASK) / GENERATION_STEP;
+        int value = old.depth - 8 * age;
+        if (value < victimValue) {
+            victim = &e;
+            victimValue = value;
+        }
+    }
+
+    uint64_t data = pack(move, score, eval, depth, generation | bound);
+    victim->store(key, data);
+}
+
+int TranspositionTable::hashfull() const noexcept {
+    size_t sampled = std::min<size_t>(1000 / BUCKET_SIZE, bucketCount);
+    int used = 0;
+    for (size_t i = 0; i < sampled; ++i) {
+        for (const HashEntry& e : buckets[i].entries) {
+            uint64_t genBound = e.raw() >> GENERATION_SHIFT;
+            used += (genBound & 0x3) != BOUND_NONE && (genBound & GENERATION_MASK) == generation;
+        }
+    }
+    return static_cast<int>(used * 1000 / (sampled * BUCKET_SIZE));
+}
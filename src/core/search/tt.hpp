@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "../game/move/packed_move.hpp"
+#include "../../util/hash_entry.hpp"
+
+// Search transposition table shared by every search thread. Entries are
+// grouped in cache-line buckets of four key-checked HashEntry slots, so
+// racing stores need no lock.
+class TranspositionTable {
+public:
+    enum Bound : uint8_t { BOUND_NONE, BOUND_UPPER, BOUND_LOWER, BOUND_EXACT };
+
+    struct Data {
+        PackedMove move;
+        int16_t    score;
+        int16_t    eval;
+        int8_t     depth;
+        Bound      bound;
+    };
+
+    explicit TranspositionTable(size_t megabytes) { resize(megabytes); }
+
+    // Reallocates and clears; only call between searches
+    void resize(size_t megabytes);
+    void clear() noexcept;
+
+    // Called once per search so entries from older searches age out first
+    void newSearch() noexcept { generation = (generation + GENERATION_STEP) & GENERATION_MASK; }
+
+    bool probe(uint64_t key, Data& out) const noexcept;
+    void store(uint64_t key, PackedMove move, int score, int eval, int depth, Bound bound) noexcept;
+
+    // Pulls the key's bucket toward the cache ahead of the probe
+    void prefetch(uint64_t key) const noexcept { __builtin_prefetch(&buckets[index(key)]); }
+
+    // Permille of sampled entries written in the current search, for UCI hashfull
+    int hashfull() const noexcept;
+
+    size_t sizeMb() const noexcept { return megabytes; }
+
+private:
+    // data: move 16 | score 16 | eval 16 | depth 8 | generation 6, bound 2
+    static constexpr int     GENERATION_SHIFT = 56;
+    static constexpr uint8_t GENERATION_STEP  = 4;     // generation sits above the bound bits
+    static constexpr uint8_t GENERATION_MASK  = 0xFC;
+    static constexpr int     BUCKET_SIZE      = 4;
+
+    struct alignas(64) Bucket {
+        HashEntry entries[BUCKET_SIZE];
+    };
+
+    static_assert(sizeof(Bucket) == 64);
+
+    // Maps the key onto [0, bucketCount) without needing a power of two
+    size_t index(uint64_t key) const noexcept {
+        return static_cast<size_t>((static_cast<unsigned __int128>(key) * bucketCount) >> 64);
+    }
+
+    static uint64_t pack(PackedMove move, int score, int eval, int depth, uint8_t genBound) noexcept {
+        return static_cast<uint64_t>(move.value)
+             | static_cast<uint64_t>(static_cast<uint16_t>(score)) << 16
+             | static_cast<uint64_t>(static_cast<uint16_t>(eval)) << 32
+             | static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 48
+             | static_cast<uint64_t>(genBound) << GENERATION_SHIFT;
+    }
+
+    static Data unpack(uint64_t data) noexcept {
+        return Data{PackedMove(static_cast<uint16_t>(data)),
+                    static_cast<int16_t>(data >> 16),
+                    static_cast<int16_t>(data >> 32),
+                    static_cast<int8_t>(data >> 48),
+                    static_cast<Bound>((data >> GENERATION_SHIFT) & 0x3)};
+    }
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t bucketCount = 0;
+    size_t megabytes = 0;
+    uint8_t generation = 0;
+};
@@ -3,13 +3,20 @@
 #include "../util/logger.hpp"
 #include "../core/game/movegen/movegen.hpp"
 #include "../core/game/move/move.hpp"
+#include "../core/game/perft/perft.hpp"
+#include "../core/search/search.hpp"
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 Engine::Engine() {
     board = Board();
+    search = std::make_unique<Search>(tt, std::cout, threads, searchParams);
     LOG("=== Engine initialized ===" << std::endl);
 }
 
 Engine::~Engine() {
+    stopSearch();
 }
 
 void Engine::initUci() {
@@ -17,7 +24,9 @@ void Engine::initUci() {
     std::cout << "id name Chess Engine v2" << std::endl;
     std::cout << "id author Juhis" << std::endl;
     std::cout << "option name Hash type spin default 128 min 1 max 1024" << std::endl;
-    std::cout << "option name Threads type spin default 1 min 1 max 8" << std::endl;
+    std::cout << "option name Threads type spin default 1 min 1 max " << maxThreads() << std::endl;
+    std::cout << "option name Ponder type check default false" << std::endl;
+    std::cout << "option name Move Overhead type spin default 20 min 0 max 5000" << std::endl;
     std::cout << "option name MultiPV type spin default 1 min 1 max 5" << std::endl;
     std::cout << "uciok" << std::endl;
     std::cout.flush();
@@ -26,13 +35,14 @@ void Engine::initUci() {
 
 void Engine::onIsReady() {
     LOG("\n=== Ready Check ===" << std::endl);
-    std::cout << "readyok" << std::endl;
-    std::cout.flush();
+    // Answered straight away, also while a search is running
+    std::cout << "readyok\n" << std::flush;
     LOG("=== Ready Check Complete ===" << std::endl);
 }
 
 void Engine::onPosition(const util::PositionCmd& pos) {
     LOG("\n=== Processing Position ===" << std::endl);
+    stopSearch();
     
     std::string token;
     if (!(pos.ss >> token)) {
@@ -81,36 +91,8 @@ void Engine::onPosition(const util::PositionCmd& pos) {
             int from = fromRank * 8 + fromFile;
             int to = toRank * 8 + toFile;
             
-            Piece piece = board.pieceAt(static_cast<Square>(from));
-            if (piece == NO_PIECE) {
-                LOG("ERROR: No piece at source square: " << token << std::endl);
-                continue;
-            }
-            
-            Piece normalizedPiece = piece != NO_PIECE
-                ? static_cast<Piece>(static_cast<int>(piece) % 6)
-                : NO_PIECE;
-            
-            Piece captured = board.pieceAt(static_cast<Square>(to));
-            Piece normalizedCaptured = captured != NO_PIECE
-                ? static_cast<Piece>(static_cast<int>(captured) % 6)
-                : NO_PIECE;
-            
-            Move move;
-            
-            if (normalizedPiece == PAWN) {
-                int rankDiff = toRank - fromRank;
-                if (abs(rankDiff) == 2 && ((piece == PAWN && fromRank == 1) || (piece == PAWN + 6 && fromRank == 6))) {
-                    move = Move(static_cast<Square>(from), static_cast<Square>(to), normalizedPiece, normalizedCaptured, NO_PIECE, Move::DPUSH);
-                } else {
-                    move = Move(static_cast<Square>(from), static_cast<Square>(to), normalizedPiece, normalizedCaptured);
-                }
-            } else {
-                move = Move(static_cast<Square>(from), static_cast<Square>(to), normalizedPiece, normalizedCaptured);
-            }
-            
+            Piece promoPiece = NO_PIECE;
             if (token.length() == 5) {
-                Piece promoPiece;
                 switch (token[4]) {
                     case 'q': promoPiece = QUEEN; break;
                     case 'r': promoPiece = ROOK; break;
@@ -118,10 +100,22 @@ void Engine::onPosition(const util::PositionCmd& pos) {
                     case 'n': promoPiece = KNIGHT; break;
                     default: promoPiece = QUEEN; break;
                 }
-                move = Move(static_cast<Square>(from), static_cast<Square>(to), normalizedPiece, normalizedCaptured, promoPiece);
             }
-            
-            if (!MoveGen::isLegalMove(board, move)) {
+
+            // Match against the legal moves so castling, en passant and
+            // double-push flags come from the generator
+            MoveList legalMoves;
+            MoveGen::generateLegalMoves(board, legalMoves);
+
+            Move move;
+            for (const Move& m : legalMoves) {
+                if (static_cast<int>(m.from()) == from && static_cast<int>(m.to()) == to && m.promotion() == promoPiece) {
+                    move = m;
+                    break;
+                }
+            }
+
+            if (move == Move()) {
                 LOG("ERROR: Illegal move: " << token << std::endl);
                 continue;
             }
@@ -141,85 +135,150 @@ void Engine::onPosition(const util::PositionCmd& pos) {
 void Engine::onGo(const util::GoCmd& go) {
     LOG("\n=== Processing Go Command ===" << std::endl);
     
+    SearchLimits limits;
     std::string token;
-    bool infinite = false;
     while (go.ss >> token) {
-        if (token == "infinite") {
-            infinite = true;
+        if (token == "depth") {
+            go.ss >> limits.depth;
+        } else if (token == "nodes") {
+            go.ss >> limits.nodes;
+        } else if (token == "movetime") {
+            go.ss >> limits.moveTimeMs;
+        } else if (token == "wtime") {
+            go.ss >> limits.wtime;
+        } else if (token == "btime") {
+            go.ss >> limits.btime;
+        } else if (token == "winc") {
+            go.ss >> limits.winc;
+        } else if (token == "binc") {
+            go.ss >> limits.binc;
+        } else if (token == "movestogo") {
+            go.ss >> limits.movesToGo;
+        } else if (token == "mate") {
+            go.ss >> limits.mate;
+        } else if (token == "infinite") {
+            limits.infinite = true;
             LOG("Infinite search mode" << std::endl);
+        } else if (token == "ponder") {
+            limits.ponder = true;
+        } else if (token == "perft") {
+            int depth = 1;
+            go.ss >> depth;
+            runPerft(depth, false);
+            return;
         }
     }
-    
-    std::vector<Move> pseudoLegalMoves = MoveGen::generatePseudoLegalMoves(board);
-    LOG("Generated " << pseudoLegalMoves.size() << " pseudo-legal moves" << std::endl);
-    
-    std::vector<Move> legalMoves;
-    for (const Move& move : pseudoLegalMoves) {
-        if (MoveGen::isLegalMove(board, move)) {
-            legalMoves.push_back(move);
-        }
-    }
-    
-    LOG("Filtered to " << legalMoves.size() << " legal moves" << std::endl);
-    
-    if (!legalMoves.empty()) {
-        Move bestMove = legalMoves[0];
-        
-        int from = static_cast<int>(bestMove.from());
-        int to = static_cast<int>(bestMove.to());
-        
-        char fromFile = 'a' + (from % 8);
-        char fromRank = '1' + (from / 8);
-        char toFile = 'a' + (to % 8);
-        char toRank = '1' + (to / 8);
-        
-        std::cout << "bestmove " << fromFile << fromRank << toFile << toRank;
-        
-        if (bestMove.isPromotion()) {
-            if ((board.getSideToMove() == WHITE && toRank == '8') || 
-                (board.getSideToMove() == BLACK && toRank == '1')) {
-                char promoPiece;
-                switch (bestMove.promotion()) {
-                    case QUEEN: promoPiece = 'q'; break;
-                    case ROOK: promoPiece = 'r'; break;
-                    case BISHOP: promoPiece = 'b'; break;
-                    case KNIGHT: promoPiece = 'n'; break;
-                    default: promoPiece = 'q'; break;
-                }
-                std::cout << promoPiece;
-            }
-        }
-        std::cout << std::endl;
-        std::cout.flush();
-        LOG("Best move sent: " << fromFile << fromRank << toFile << toRank);
-        if (bestMove.isPromotion()) {
-            LOG(" (promotion)");
-        }
-        LOG(std::endl);
-    } else {
-        std::cout << "bestmove 0000" << std::endl;
-        std::cout.flush();
-        LOG("No legal moves, sent 0000" << std::endl);
+
+    limits.moveOverheadMs = moveOverheadMs;
+
+    // A go without any limit searches to a fixed depth
+    if (!limits.depth && !limits.nodes && !limits.mate && !limits.moveTimeMs
+        && !limits.wtime && !limits.btime && !limits.infinite) {
+        limits.depth = DEFAULT_DEPTH;
     }
-    
-    if (!infinite) {
-        LOG("=== Go Command Processing Complete ===" << std::endl);
-    } else {
-        LOG("=== Go Command Processing Complete (Infinite Mode) ===" << std::endl);
+
+    // The search thread prints bestmove itself; this thread goes back to
+    // reading commands right away
+    stopSearch();
+    search->start(board, limits, [](const SearchResult& result) {
+        std::string line = "bestmove " + (result.bestMove == Move() ? std::string("0000") : moveToUci(result.bestMove)) + "\n";
+        std::cout << line << std::flush;
+        LOG("Best move sent after " << result.nodes << " nodes" << std::endl);
+    });
+    LOG("=== Go Command Processing Complete ===" << std::endl);
+}
+
+void Engine::stopSearch() {
+    if (search) {
+        search->requestStop();
+        search->wait();
     }
 }
 
+void Engine::onDivide(std::istringstream& ss) {
+    LOG("\n=== Divide Command Received ===" << std::endl);
+    int depth = 1;
+    ss >> depth;
+    runPerft(depth, true);
+}
+
+void Engine::runPerft(int depth, bool perMove) {
+    stopSearch();
+    auto start = std::chrono::steady_clock::now();
+    uint64_t nodes = perMove ? Perft::divide(board, depth, std::cout)
+                             : Perft::runParallel(board, depth, threads, hashMb);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "info depth " << depth << " nodes " << nodes << " time " << elapsed
+              << " nps " << (nodes * 1000 / (elapsed + 1)) << std::endl;
+    std::cout << "Nodes searched: " << nodes << std::endl;
+    std::cout.flush();
+}
+
+int Engine::maxThreads() {
+    return std::max(8, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
 void Engine::onStop() {
     LOG("\n=== Stop Command Received ===" << std::endl);
+    stopSearch();
+}
+
+void Engine::onPonderHit() {
+    LOG("\n=== Ponderhit Received ===" << std::endl);
+    if (search) {
+        search->ponderhit();
+    }
+}
+
+void Engine::onQuit() {
+    LOG("\n=== Quit Received ===" << std::endl);
+    stopSearch();
 }
 
 void Engine::onSetOption(std::istringstream& ss) {
     LOG("\n=== SetOption Command Received ===" << std::endl);
+    stopSearch();  // Hash resizes the table the search threads use
+
+    // setoption name <id> [value <x>]
+    std::string token, name, value;
+    ss >> token;
+    while (ss >> token && token != "value") {
+        name += (name.empty() ? "" : " ") + token;
+    }
+    std::getline(ss >> std::ws, value);
+
+    try {
+        if (name == "Threads") {
+            int requested = std::clamp(std::stoi(value), 1, maxThreads());
+            if (requested != threads) {
+                threads = requested;
+                search = std::make_unique<Search>(tt, std::cout, threads, searchParams);
+            }
+        } else if (name == "Move Overhead") {
+            moveOverheadMs = std::clamp(std::stoi(value), 0, 5000);
+        } else if (name == "Hash") {
+            hashMb = std::clamp(std::stoi(value), 1, 1024);
+            tt.resize(hashMb);
+        } else if (searchParams.set(name, std::stoi(value))) {
+            search->setParams(searchParams);
+        } else {
+            LOG("Ignoring unknown option: " << name << std::endl);
+            return;
+        }
+    } catch (const std::exception&) {
+        LOG("ERROR: Invalid value for " << name << ": " << value << std::endl);
+        return;
+    }
+    LOG("Set " << name << " = " << value << std::endl);
 }
 
 void Engine::onNewGame() {
     LOG("\n=== New Game Command Received ===" << std::endl);
+    stopSearch();
     board = Board();
+    tt.clear();
+    search->clearHistory();
 }
 
 
@@ -4,6 +4,9 @@
 #include <sstream>
 #include "../util/util.hpp"
 #include "../core/game/board/board.hpp"
+#include "../core/search/search.hpp"
+#include "../core/search/tt.hpp"
+#include <memory>
 
 class Engine {
     public:
@@ -15,13 +18,41 @@ class Engine {
         void onPosition(const util::PositionCmd& position);
         void onGo(const util::GoCmd& go);
         void onStop();
+        void onPonderHit();
+        void onQuit();
         void onSetOption(std::istringstream& ss);
         void onNewGame();
+        void onDivide(std::istringstream& ss);
 
     private:
         bool is_ready = false;
         Board board;
 
+        // UCI options
+        int threads = 1;
+        int hashMb = 128;
+        int moveOverheadMs = 20;
+
+        // Hidden options: accepted by setoption, not listed in the uci reply
+        SearchParams searchParams;
+
+        TranspositionTable tt{static_cast<size_t>(hashMb)};
+
+        // Runs each go on its own thread. Kept for the whole game so move
+        // ordering history carries over between moves; rebuilt only when
+        // Threads changes, cleared by ucinewgame.
+        std::unique_ptr<Search> search;
+        void stopSearch();
+
+        // Depth searched by a go command without any limit
+        static constexpr int DEFAULT_DEPTH = 6;
+
+        void runPerft(int depth, bool perMove);
+
+        // Upper bound of the Threads option: the hardware concurrency, but
+        // never below the old fixed maximum of 8
+        static int maxThreads();
+
 };
 
 #endif // ENGINE_HPP
\ No newline at end of file
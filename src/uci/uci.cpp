@@ -42,14 +42,21 @@ void UCI::run() {
         } else if (token == "stop") {
             LOG("Handling stop command" << std::endl);
             engine->onStop();
+        } else if (token == "ponderhit") {
+            LOG("Handling ponderhit command" << std::endl);
+            engine->onPonderHit();
         } else if (token == "setoption") {
             LOG("Handling setoption command" << std::endl);
             engine->onSetOption(ss);
         } else if (token == "ucinewgame") {
             LOG("Handling ucinewgame command" << std::endl);
             engine->onNewGame();
+        } else if (token == "divide") {
+            LOG("Handling divide command" << std::endl);
+            engine->onDivide(ss);
         } else if (token == "quit") {
             LOG("Handling quit command" << std::endl);
+            engine->onQuit();
             break;
         } else {
             LOG("Unknown command: " << token << std::endl);
@@ -0,0 +1,29 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// One slot of a hash table shared between threads without locks. The slot
+// holds (key ^ data, data) in relaxed atomics; a torn write from two racing
+// stores fails the key check and reads as a miss.
+class HashEntry {
+public:
+    // Reads the data and whether it was stored under `key`
+    bool load(uint64_t key, uint64_t& out) const noexcept {
+        out = data.load(std::memory_order_relaxed);
+        return (check.load(std::memory_order_relaxed) ^ out) == key;
+    }
+
+    // The data without the key check, for callers that only sample the table
+    uint64_t raw() const noexcept { return data.load(std::memory_order_relaxed); }
+
+    void store(uint64_t key, uint64_t value) noexcept {
+        check.store(key ^ value, std::memory_order_relaxed);
+        data.store(value, std::memory_order_relaxed);
+    }
+
+    void clear() noexcept { store(0, 0); }
+
+private:
+    std::atomic<uint64_t> check{0};
+    std::atomic<uint64_t> data{0};
+};
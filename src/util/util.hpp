@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <sstream>
 #include <cstdint>
 
@@ -24,6 +25,10 @@ namespace util {
 
     enum Piece : int { NO_PIECE = -1, PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING };
 
+    // Centipawns by piece type for both evaluation and SEE, the king has no
+    // material value
+    inline constexpr std::array<int, 6> PIECE_VALUES{100, 320, 330, 500, 900, 0};
+
     enum class Square : int {
         A1 = 0,  B1, C1, D1, E1, F1, G1, H1,
         A2 = 8,  B2, C2, D2, E2, F2, G2, H2,
@@ -1,19 +1,60 @@
 #pragma once
 #include <array>
 #include <cstdint>
-#include "../core/game/board/board.hpp"
+#include "util.hpp"
 
+using namespace util;
+
+class Board;
+
+// Zobrist keys are fixed at compile time from a seeded SplitMix64 stream,
+// so hashes are identical across runs and processes.
 namespace Zobrist {
-    extern std::array<std::array<uint64_t, 64>, 12> pieceKeys;  // [piece][square]
-    extern uint64_t sideToMove;
-    extern uint64_t castlingRights[16];
-    extern uint64_t enPassant[8];
+    struct Keys {
+        std::array<std::array<uint64_t, 64>, 12> piece{};   // [piece][square]
+        uint64_t sideToMove{};
+        std::array<uint64_t, 16> castling{};                 // [rights], no rights hashes to 0
+        std::array<uint64_t, 8>  enPassant{};                // [file]
+    };
+
+    constexpr uint64_t splitMix64(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    constexpr Keys generateKeys(uint64_t seed) {
+        Keys keys;
+        for (auto& squares : keys.piece)
+            for (auto& key : squares)
+                key = splitMix64(seed);
+        keys.sideToMove = splitMix64(seed);
+        for (int i = 1; i < 16; ++i)
+            keys.castling[i] = splitMix64(seed);
+        for (auto& key : keys.enPassant)
+            key = splitMix64(seed);
+        return keys;
+    }
+
+    inline constexpr Keys KEYS = generateKeys(0x2545F4914F6CDD1DULL);
+
+    constexpr uint64_t pieceSquare(Piece piece, Square square) {
+        return KEYS.piece[static_cast<int>(piece)][static_cast<int>(square)];
+    }
+
+    constexpr uint64_t sideToMoveKey() {
+        return KEYS.sideToMove;
+    }
+
+    constexpr uint64_t castlingKey(uint8_t rights) {
+        return KEYS.castling[rights];
+    }
 
-    void init();
-    uint64_t pieceSquare(Piece piece, Square square);
-    uint64_t sideToMoveKey();
-    uint64_t castlingKey(uint8_t rights);
-    uint64_t enPassantKey(int file);
+    constexpr uint64_t enPassantKey(int file) {
+        return file >= 0 ? KEYS.enPassant[file] : 0;
+    }
 
+    // Full key from scratch: pieces, side to move, castling rights and en passant file
     uint64_t hashPosition(const Board& board);
-} 
\ No newline at end of file
+} 